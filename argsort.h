@@ -0,0 +1,96 @@
+#ifndef ARGSORT_H
+#define ARGSORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "parallel_sort.h"
+#include "thread_pool.h"
+
+// 间接排序（argsort）：不搬移元素本身，只对 (键, 下标) 对排序，返回排列 p，
+// 使 values[p[0]], values[p[1]], ... 按键升序。元素越宽，相比直接排序省下的搬移越多；
+// 需要物理重排时再用 applyPermutation 按排列原地移动一次。
+
+// 排序对象：只按 key 比较；提供 sortKey() 时可直接用于基数排序（见 radix_sort.h）
+template <typename Key, typename Index>
+struct ArgsortEntry {
+    Key key;
+    Index index;
+
+    Key sortKey() const { return key; }
+    bool operator<(const ArgsortEntry& other) const { return key < other.key; }
+};
+
+// 取出每个元素的键，与原始下标组成待排序的数组
+template <typename Index = uint32_t, typename T, typename KeyOf = std::identity>
+auto makeArgsortEntries(std::span<const T> values, KeyOf keyOf = {}) {
+    using Key = std::remove_cvref_t<std::invoke_result_t<KeyOf&, const T&>>;
+    if (values.size() > static_cast<size_t>(std::numeric_limits<Index>::max())) {
+        throw std::length_error("argsort: too many elements for the index type");
+    }
+    std::vector<ArgsortEntry<Key, Index>> entries;
+    entries.reserve(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        entries.push_back({std::invoke(keyOf, values[i]), static_cast<Index>(i)});
+    }
+    return entries;
+}
+
+// 用 algorithm 对键排序，返回排列；稳定算法得到的排列中相等键保持原有顺序
+template <typename Index = uint32_t, typename T, typename KeyOf = std::identity>
+std::vector<Index> argsort(SortAlgorithm algorithm, std::span<const T> values, ThreadPool& pool, KeyOf keyOf = {}) {
+    auto entries = makeArgsortEntries<Index>(values, keyOf);
+    using Entry = typename decltype(entries)::value_type;
+    std::vector<Entry> scratch(entries.size());
+    dispatchSort<Entry, std::less<Entry>, NoInstrumentation>(algorithm, entries, scratch, &pool);
+
+    std::vector<Index> permutation(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) permutation[i] = entries[i].index;
+    return permutation;
+}
+
+// 按排列重排：完成后 values[i] 为原来的 values[permutation[i]]，permutation 必须是 0..n-1 的排列。
+// 不给 scratch 时原地沿置换的环依次搬移，每个元素只移动一次（另加每个环一次暂存），
+// 已就位的元素用 n 位的位图标记，不修改也不复制 permutation；
+// scratch 不小于 n 时改为按排列收集到 scratch 再顺序搬回：各次读取互不依赖、可以并发访存，
+// 而沿环搬移的每一步都要等上一步读出下标，元素越多越慢
+template <typename T, typename Index>
+void applyPermutation(std::span<T> values, std::span<const Index> permutation, std::span<T> scratch = {}) {
+    size_t n = values.size();
+    if (permutation.size() != n) throw std::invalid_argument("applyPermutation: size mismatch");
+
+    if (scratch.size() >= n) {
+        for (size_t i = 0; i < n; i++) scratch[i] = std::move(values[static_cast<size_t>(permutation[i])]);
+        std::move(scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(n), values.begin());
+        return;
+    }
+
+    std::vector<uint64_t> placed((n + 63) / 64, 0);
+    auto isPlaced = [&](size_t i) { return (placed[i >> 6] >> (i & 63)) & 1; };
+    auto markPlaced = [&](size_t i) { placed[i >> 6] |= uint64_t(1) << (i & 63); };
+
+    for (size_t start = 0; start < n; start++) {
+        if (isPlaced(start)) continue;
+        size_t source = static_cast<size_t>(permutation[start]);
+        if (source == start) continue; // 不动点
+
+        T saved = std::move(values[start]);
+        size_t current = start;
+        while (source != start) {
+            values[current] = std::move(values[source]);
+            markPlaced(current);
+            current = source;
+            source = static_cast<size_t>(permutation[current]);
+        }
+        values[current] = std::move(saved);
+        markPlaced(current);
+    }
+}
+
+#endif // ARGSORT_H
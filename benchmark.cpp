@@ -0,0 +1,398 @@
+#include "benchmark.h"
+#include "data_generator.h"
+#include "dataset_io.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// 双侧 95% Student t 分布临界值，下标为自由度 1..30；更大的自由度近似取正态分布的 1.96
+constexpr double kStudentT95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double studentT95(size_t degreesOfFreedom) {
+    if (degreesOfFreedom == 0) return 0.0;
+    if (degreesOfFreedom <= std::size(kStudentT95)) return kStudentT95[degreesOfFreedom - 1];
+    return 1.96;
+}
+
+// 线性插值的百分位数，sorted 已升序且非空
+double percentile(const std::vector<double>& sorted, double p) {
+    double rank = p * static_cast<double>(sorted.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+}
+
+std::string csvEscape(const std::string& text) {
+    if (text.find_first_of(",\"") == std::string::npos) return text;
+    std::string escaped = "\"";
+    for (char c : text) {
+        if (c == '"') escaped += '"';
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// argsort 使用的键：int 为其本身，记录为 key 字段
+struct ElementKey {
+    int32_t operator()(int value) const { return value; }
+    template <size_t Bytes>
+    int32_t operator()(const SortRecord<Bytes>& record) const { return record.key; }
+};
+
+// 生成数据时为模式名，读文件时为 "File"
+const char* patternLabel(const BenchmarkResult& result) {
+    return result.pattern ? dataPatternName(*result.pattern) : "File";
+}
+
+// JSON 中不可用的计数器写为 null，CSV 中留空
+void writeHardwareJson(std::ostream& out, const HardwareCounters& counters) {
+    for (size_t i = 0; i < kHardwareCounterCount; i++) {
+        auto counter = static_cast<HardwareCounter>(i);
+        out << ", \"" << hardwareCounterName(counter) << "\": ";
+        if (counters.has(counter)) out << counters.get(counter);
+        else out << "null";
+    }
+}
+
+void writeHardwareCsv(std::ostream& out, const HardwareCounters& counters) {
+    for (size_t i = 0; i < kHardwareCounterCount; i++) {
+        auto counter = static_cast<HardwareCounter>(i);
+        if (counters.has(counter)) out << counters.get(counter);
+        out << ',';
+    }
+}
+
+} // namespace
+
+TimingSummary summarizeTimings(std::vector<double> samples) {
+    TimingSummary summary;
+    summary.samples = samples.size();
+    if (samples.empty()) return summary;
+
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    summary.min = samples.front();
+    summary.median = percentile(samples, 0.5);
+    summary.p95 = percentile(samples, 0.95);
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(n);
+
+    if (n > 1) {
+        double squares = 0.0;
+        for (double sample : samples) squares += (sample - summary.mean) * (sample - summary.mean);
+        summary.stddev = std::sqrt(squares / static_cast<double>(n - 1));
+    }
+    double halfWidth = studentT95(n - 1) * summary.stddev / std::sqrt(static_cast<double>(n));
+    summary.ciLow = summary.mean - halfWidth;
+    summary.ciHigh = summary.mean + halfWidth;
+    return summary;
+}
+
+const char* sortStrategyName(SortStrategy strategy) {
+    switch (strategy) {
+        case SortStrategy::Direct: return "direct";
+        case SortStrategy::Argsort: return "argsort";
+        case SortStrategy::ArgsortInPlace: return "argsort-inplace";
+    }
+    return "Unknown";
+}
+
+bool probeSortStability(SortAlgorithm algorithm, ThreadPool& pool) {
+    using Record = SortRecord<16>;
+    size_t size = BenchmarkRunner::isQuadraticCase(algorithm, DataPattern::FewUnique) ? 2048 : (1 << 15);
+    return probeStability<Record>(size, [&](std::span<Record> records) {
+        std::vector<Record> scratch(records.size());
+        dispatchSort<Record, std::less<Record>, NoInstrumentation>(algorithm, records, scratch, &pool);
+    });
+}
+
+BenchmarkRunner::BenchmarkRunner(BenchmarkConfig config) : config(std::move(config)), pool(this->config.threadCount) {}
+
+bool BenchmarkRunner::isQuadraticCase(SortAlgorithm algorithm, std::optional<DataPattern> pattern) {
+    switch (algorithm) {
+        case SortAlgorithm::BubbleSort:
+        case SortAlgorithm::InsertionSort:
+        case SortAlgorithm::SelectionSort:
+            return true;
+        case SortAlgorithm::QuickSort:
+            // 经典快排以末元素为枢轴且不处理相等元素：有序结构（升序、逆序、锯齿、分段有序等）
+            // 和大量重复键（FewUnique、Zipfian）都会退化为 O(n²)，递归深度接近 n；
+            // 文件数据分布未知，同样视为可能退化
+            return !pattern || (*pattern != DataPattern::Random && *pattern != DataPattern::Gaussian &&
+                                *pattern != DataPattern::WideRange);
+        default:
+            return false;
+    }
+}
+
+bool BenchmarkRunner::isSupportedElementSize(size_t bytes) {
+    return std::find(std::begin(kBenchmarkElementSizes), std::end(kBenchmarkElementSizes), bytes) !=
+           std::end(kBenchmarkElementSizes);
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(const std::function<void(const BenchmarkResult&)>& onResult) {
+    std::vector<BenchmarkResult> results;
+
+    if (!config.inputPath.empty()) {
+        MappedDataset dataset(config.inputPath);
+        std::span<int32_t> values = dataset.elements<int32_t>();
+        runInput(std::vector<int>(values.begin(), values.end()), std::nullopt, config.inputPath, results,
+                 onResult);
+        return results;
+    }
+
+    uint64_t seed = config.seed ? *config.seed : randomSeed();
+    for (DataPattern pattern : config.patterns) {
+        for (size_t size : config.sizes) {
+            std::vector<int> input = SortingSystem::generateTestData(size, pattern, seed, &pool, config.patternParams);
+            runInput(input, pattern, std::string(), results, onResult);
+        }
+    }
+    return results;
+}
+
+void BenchmarkRunner::runInput(const std::vector<int>& input, std::optional<DataPattern> pattern, const std::string& inputName,
+                               std::vector<BenchmarkResult>& results,
+                               const std::function<void(const BenchmarkResult&)>& onResult) {
+    for (size_t bytes : config.elementSizes) {
+        switch (bytes) {
+            case 4: runElements(input, pattern, inputName, results, onResult); break;
+            case 8: runElements(makeSortRecords<SortRecord<8>>(input), pattern, inputName, results, onResult); break;
+            case 16: runElements(makeSortRecords<SortRecord<16>>(input), pattern, inputName, results, onResult); break;
+            case 64: runElements(makeSortRecords<SortRecord<64>>(input), pattern, inputName, results, onResult); break;
+            default: throw std::invalid_argument("unsupported element size: " + std::to_string(bytes));
+        }
+    }
+}
+
+template <typename T>
+void BenchmarkRunner::runElements(const std::vector<T>& input, std::optional<DataPattern> pattern, const std::string& inputName,
+                                  std::vector<BenchmarkResult>& results,
+                                  const std::function<void(const BenchmarkResult&)>& onResult) {
+    // 同一输入下所有算法使用完全相同的数据
+    size_t size = input.size();
+    std::vector<T> work(size);
+    std::vector<T> scratch(size);
+    bool measureHardware = config.collectHardwareCounters && perf.available();
+
+    for (SortAlgorithm algorithm : config.algorithms) {
+        if (size > config.quadraticSizeLimit && isQuadraticCase(algorithm, pattern)) continue;
+
+        for (SortStrategy strategy : config.strategies) {
+            BenchmarkResult result{.algorithm = algorithm, .strategy = strategy, .pattern = pattern, .size = size,
+                                   .elementBytes = sizeof(T), .input = inputName};
+            std::vector<double> samples;
+            HardwareCounters hardwareTotal;
+            bool observedStable = true;
+            for (int run = 0; run < config.warmupRuns + config.trials; run++) {
+                std::copy(input.begin(), input.end(), work.begin());
+                bool timed = run >= config.warmupRuns;
+                if (timed && measureHardware) perf.start();
+                auto start = std::chrono::steady_clock::now();
+                if (strategy == SortStrategy::Direct) {
+                    dispatchSort<T, std::less<T>, NoInstrumentation>(algorithm, work, scratch, &pool);
+                } else {
+                    std::vector<uint32_t> permutation =
+                        argsort(algorithm, std::span<const T>(work), pool, ElementKey());
+                    if (strategy == SortStrategy::Argsort) {
+                        applyPermutation<T, uint32_t>(work, permutation, scratch);
+                    } else {
+                        applyPermutation<T, uint32_t>(work, permutation);
+                    }
+                }
+                auto end = std::chrono::steady_clock::now();
+                if (timed && measureHardware) hardwareTotal += perf.stop();
+
+                if (run == 0) {
+                    if constexpr (std::is_same_v<T, int>) {
+                        result.verified = std::is_sorted(work.begin(), work.end());
+                    } else {
+                        RecordOrderCheck check = checkRecordOrder<T>(work);
+                        result.verified = check.sorted && check.intact;
+                        observedStable = check.stable;
+                    }
+                }
+                if (timed) {
+                    samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                }
+            }
+
+            result.timing = summarizeTimings(std::move(samples));
+            result.hardware = hardwareTotal.dividedBy(static_cast<uint64_t>(std::max(config.trials, 1)));
+            result.nsPerElement = size > 0 ? result.timing.median * 1e6 / static_cast<double>(size) : 0.0;
+            if (config.checkStability) result.stable = observedStable && isStable(algorithm);
+
+            if (config.collectCounters) {
+                SortOperationCounts counts;
+                if (strategy == SortStrategy::Direct) {
+                    std::copy(input.begin(), input.end(), work.begin());
+                    counts = dispatchSort<T>(algorithm, work, scratch, &pool);
+                } else {
+                    // 两种 argsort 只统计对 (键, 下标) 排序的操作，不含最后的重排
+                    auto entries = makeArgsortEntries(std::span<const T>(input), ElementKey());
+                    using Entry = typename decltype(entries)::value_type;
+                    std::vector<Entry> entryScratch(entries.size());
+                    counts = dispatchSort<Entry>(algorithm, entries, entryScratch, &pool);
+                }
+                result.comparisons = counts.comparisons;
+                result.swaps = counts.swaps;
+                result.passes = counts.passes;
+                result.bytesMoved = counts.bytesMoved;
+            }
+
+            results.push_back(result);
+            if (onResult) onResult(result);
+        }
+    }
+}
+
+bool BenchmarkRunner::isStable(SortAlgorithm algorithm) {
+    auto it = stability.find(algorithm);
+    if (it == stability.end()) it = stability.emplace(algorithm, probeSortStability(algorithm, pool)).first;
+    return it->second;
+}
+
+void BenchmarkRunner::writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results) const {
+    out << std::setprecision(6) << std::fixed;
+    out << "{\n";
+    out << "  \"config\": {\"warmup\": " << config.warmupRuns
+        << ", \"trials\": " << config.trials
+        << ", \"threads\": " << pool.getThreadCount()
+        << ", \"simd\": \"" << simdLevelName(getSimdLevel()) << "\""
+        << ", \"heap_arity\": " << getDefaultHeapArity();
+    if (config.seed) out << ", \"seed\": " << *config.seed;
+    const PatternParams& params = config.patternParams;
+    out << ", \"pattern_params\": {\"partial_fraction\": " << params.partialFraction
+        << ", \"unique_count\": " << params.uniqueCount
+        << ", \"zipf_exponent\": " << params.zipfExponent
+        << ", \"zipf_universe\": " << params.zipfUniverse
+        << ", \"gaussian_stddev\": " << params.gaussianStddev
+        << ", \"sawtooth_period\": " << params.sawtoothPeriod
+        << ", \"displacement\": " << params.displacement
+        << ", \"run_length\": " << params.runLength << "}";
+    out << ", \"strategies\": [";
+    for (size_t i = 0; i < config.strategies.size(); i++) {
+        out << (i == 0 ? "" : ", ") << "\"" << sortStrategyName(config.strategies[i]) << "\"";
+    }
+    out << "]";
+    out << ", \"element_sizes\": [";
+    for (size_t i = 0; i < config.elementSizes.size(); i++) out << (i == 0 ? "" : ", ") << config.elementSizes[i];
+    out << "]";
+    out << ", \"hardware_counters\": " << (config.collectHardwareCounters && perf.available() ? "true" : "false")
+        << "},\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"algorithm\": \"" << sortAlgorithmName(r.algorithm) << "\""
+            << ", \"strategy\": \"" << sortStrategyName(r.strategy) << "\""
+            << ", \"pattern\": \"" << patternLabel(r) << "\"";
+        if (!r.input.empty()) out << ", \"input\": \"" << jsonEscape(r.input) << "\"";
+        out << ", \"size\": " << r.size
+            << ", \"element_bytes\": " << r.elementBytes
+            << ", \"samples\": " << r.timing.samples
+            << ", \"min_ms\": " << r.timing.min
+            << ", \"median_ms\": " << r.timing.median
+            << ", \"mean_ms\": " << r.timing.mean
+            << ", \"p95_ms\": " << r.timing.p95
+            << ", \"stddev_ms\": " << r.timing.stddev
+            << ", \"ci95_low_ms\": " << r.timing.ciLow
+            << ", \"ci95_high_ms\": " << r.timing.ciHigh
+            << ", \"ns_per_element\": " << r.nsPerElement
+            << ", \"comparisons\": " << r.comparisons
+            << ", \"swaps\": " << r.swaps
+            << ", \"passes\": " << r.passes
+            << ", \"bytes_moved\": " << r.bytesMoved;
+        writeHardwareJson(out, r.hardware);
+        out << ", \"stable\": " << (r.stable ? (*r.stable ? "true" : "false") : "null")
+            << ", \"verified\": " << (r.verified ? "true" : "false") << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void BenchmarkRunner::writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results) const {
+    out << std::setprecision(6) << std::fixed;
+    out << "algorithm,strategy,pattern,input,size,element_bytes,samples,min_ms,median_ms,mean_ms,p95_ms,stddev_ms,ci95_low_ms,ci95_high_ms,"
+           "ns_per_element,comparisons,swaps,passes,bytes_moved,";
+    for (size_t i = 0; i < kHardwareCounterCount; i++) out << hardwareCounterName(static_cast<HardwareCounter>(i)) << ',';
+    out << "stable,verified\n";
+    for (const BenchmarkResult& r : results) {
+        out << csvEscape(sortAlgorithmName(r.algorithm)) << ','
+            << sortStrategyName(r.strategy) << ','
+            << csvEscape(patternLabel(r)) << ','
+            << csvEscape(r.input) << ','
+            << r.size << ','
+            << r.elementBytes << ','
+            << r.timing.samples << ','
+            << r.timing.min << ','
+            << r.timing.median << ','
+            << r.timing.mean << ','
+            << r.timing.p95 << ','
+            << r.timing.stddev << ','
+            << r.timing.ciLow << ','
+            << r.timing.ciHigh << ','
+            << r.nsPerElement << ','
+            << r.comparisons << ','
+            << r.swaps << ','
+            << r.passes << ','
+            << r.bytesMoved << ',';
+        writeHardwareCsv(out, r.hardware);
+        if (r.stable) out << (*r.stable ? "true" : "false");
+        out << ',' << (r.verified ? "true" : "false") << '\n';
+    }
+}
+
+void BenchmarkRunner::writeTableHeader(std::ostream& out) {
+    out << std::left << std::setw(22) << "算法"
+        << std::setw(9) << "方式"
+        << std::setw(17) << "数据模式"
+        << std::setw(10) << "规模"
+        << std::setw(6) << "字节"
+        << std::setw(12) << "中位(ms)"
+        << std::setw(12) << "p95(ms)"
+        << std::setw(12) << "标准差"
+        << std::setw(24) << "95% 置信区间"
+        << std::setw(10) << "ns/元素"
+        << std::setw(8) << "IPC"
+        << std::setw(6) << "稳定" << std::endl;
+    out << std::string(148, '-') << std::endl;
+}
+
+void BenchmarkRunner::writeTableRow(std::ostream& out, const BenchmarkResult& r) {
+    std::ostringstream ci;
+    ci << std::fixed << std::setprecision(3) << "[" << r.timing.ciLow << ", " << r.timing.ciHigh << "]";
+    std::ostringstream ipc;
+    if (r.hardware.ipc() > 0.0) ipc << std::fixed << std::setprecision(2) << r.hardware.ipc();
+    else ipc << "-";
+    out << std::left << std::setw(22) << sortAlgorithmName(r.algorithm)
+        << std::setw(9) << sortStrategyName(r.strategy)
+        << std::setw(17) << patternLabel(r)
+        << std::setw(10) << r.size
+        << std::setw(6) << r.elementBytes
+        << std::setw(12) << std::fixed << std::setprecision(3) << r.timing.median
+        << std::setw(12) << r.timing.p95
+        << std::setw(12) << r.timing.stddev
+        << std::setw(24) << ci.str()
+        << std::setw(10) << std::setprecision(2) << r.nsPerElement
+        << std::setw(8) << ipc.str()
+        << std::setw(6) << (r.stable ? (*r.stable ? "是" : "否") : "-")
+        << (r.verified ? "" : "  结果错误!") << std::endl;
+}
@@ -0,0 +1,127 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+#include "argsort.h"
+#include "sorting_engine.h"
+#include "sorting_system.h"
+#include "parallel_sort.h"
+#include "perf_counters.h"
+#include "sort_record.h"
+#include "thread_pool.h"
+
+// 多次计时的统计摘要（单位：毫秒）
+struct TimingSummary {
+    size_t samples = 0;
+    double min = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double p95 = 0.0;
+    double stddev = 0.0;   // 样本标准差
+    double ciLow = 0.0;    // 均值的 95% 置信区间（Student t）
+    double ciHigh = 0.0;
+};
+
+TimingSummary summarizeTimings(std::vector<double> samples);
+
+// 基准测试支持的元素宽度（字节）：4 为 int，8/16/64 为 SortRecord（见 sort_record.h）
+inline constexpr size_t kBenchmarkElementSizes[] = {4, 8, 16, 64};
+
+// 排序方式：直接搬移元素，或先对 (键, 下标) 做 argsort 再按排列重排一次（见 argsort.h）。
+// Argsort 借助 n 个元素的暂存按排列收集，ArgsortInPlace 不给暂存、沿置换的环原地搬移
+enum class SortStrategy {
+    Direct,
+    Argsort,
+    ArgsortInPlace
+};
+
+const char* sortStrategyName(SortStrategy strategy);
+
+// 基准测试矩阵：algorithms × strategies × patterns × sizes × elementSizes
+struct BenchmarkConfig {
+    std::vector<SortAlgorithm> algorithms{kAllSortAlgorithms.begin(), kAllSortAlgorithms.end()};
+    std::vector<DataPattern> patterns{DataPattern::Random, DataPattern::Ascending,
+                                      DataPattern::Descending, DataPattern::PartiallySorted};
+    std::vector<size_t> sizes{1000, 10000, 100000};
+    // 被排序元素的宽度：记录以生成的 int 数据为键，附带原始下标，排序后逐一检查稳定性
+    std::vector<size_t> elementSizes{sizeof(int)};
+    std::vector<SortStrategy> strategies{SortStrategy::Direct};
+    int warmupRuns = 2;
+    int trials = 10;
+    // 超过该规模时跳过 O(n²) 的情形（冒泡/插入/选择排序，以及经典快排在有序结构或大量重复的数据上）
+    size_t quadraticSizeLimit = 20000;
+    bool collectCounters = true; // 额外用计数插桩跑一次，记录比较/交换次数
+    bool collectHardwareCounters = true; // 计时运行同时读取硬件计数器（不可用时自动跳过）
+    bool checkStability = true;  // 每个算法用 probeSortStability 实测一次稳定性
+    size_t threadCount = 0;      // 并行算法的线程数，0 表示硬件并发数
+    PatternParams patternParams;  // 各数据分布的参数
+    std::optional<uint64_t> seed; // 数据生成种子，未设置时每次运行随机
+    // 非空时以该数据集文件（int32，见 dataset_io.h）为唯一输入，忽略 patterns 与 sizes
+    std::string inputPath;
+};
+
+struct BenchmarkResult {
+    SortAlgorithm algorithm;
+    SortStrategy strategy = SortStrategy::Direct;
+    std::optional<DataPattern> pattern; // 读文件时为空：数据分布未知
+    size_t size;
+    size_t elementBytes = sizeof(int);
+    std::string input;       // 输入数据集文件，生成数据时为空
+    TimingSummary timing{};
+    double nsPerElement = 0.0; // 中位数 / 元素个数
+    size_t comparisons = 0;
+    size_t swaps = 0;
+    size_t passes = 0;
+    size_t bytesMoved = 0;
+    HardwareCounters hardware{}; // 计时运行的每次平均值
+    bool verified = false;   // 排序结果是否有序（记录还要求是原记录的排列且载荷完整）
+    // 实测稳定性：探测数据上相等键保持原有顺序，且（记录输入时）本次结果中同样如此；未检查时为空
+    std::optional<bool> stable{};
+};
+
+// 实测算法稳定性：对大量重复键的 (键, 原始下标) 记录排序，检查相等键是否保持原有顺序。
+// 探测规模超过 ParallelSorter::kSequentialThreshold，并行算法会走并行路径；O(n²) 的情形用较小的规模
+bool probeSortStability(SortAlgorithm algorithm, ThreadPool& pool);
+
+class BenchmarkRunner {
+public:
+    explicit BenchmarkRunner(BenchmarkConfig config);
+
+    // onResult 在每个单元格完成后回调，可用于显示进度
+    std::vector<BenchmarkResult> run(const std::function<void(const BenchmarkResult&)>& onResult = {});
+
+    // pattern 为空（文件数据）时分布未知，按可能退化处理
+    static bool isQuadraticCase(SortAlgorithm algorithm, std::optional<DataPattern> pattern);
+    static bool isSupportedElementSize(size_t bytes);
+
+    void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results) const;
+    void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results) const;
+    // 人读的对齐表格，可逐行输出作为进度
+    static void writeTableHeader(std::ostream& out);
+    static void writeTableRow(std::ostream& out, const BenchmarkResult& result);
+
+    const PerfCounterGroup& hardwareCounters() const { return perf; }
+
+private:
+    BenchmarkConfig config;
+    ThreadPool pool;
+    PerfCounterGroup perf;
+    std::map<SortAlgorithm, bool> stability; // probeSortStability 的结果，每个算法只探测一次
+
+    void runInput(const std::vector<int>& input, std::optional<DataPattern> pattern, const std::string& inputName,
+                  std::vector<BenchmarkResult>& results, const std::function<void(const BenchmarkResult&)>& onResult);
+    template <typename T>
+    void runElements(const std::vector<T>& input, std::optional<DataPattern> pattern, const std::string& inputName,
+                     std::vector<BenchmarkResult>& results,
+                     const std::function<void(const BenchmarkResult&)>& onResult);
+    bool isStable(SortAlgorithm algorithm);
+};
+
+#endif // BENCHMARK_H
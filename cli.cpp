@@ -0,0 +1,418 @@
+#include "cli.h"
+#include "dataset_io.h"
+#include "replay_experiments.h"
+#include "sort_benchmarks.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+// 小写并去掉空格、'-'、'_'
+std::string normalizeName(const std::string& name) {
+    std::string normalized;
+    for (char c : name) {
+        if (c == ' ' || c == '-' || c == '_') continue;
+        normalized += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return normalized;
+}
+
+bool matchesName(const std::string& normalized, const char* canonical) {
+    std::string full = normalizeName(canonical);
+    if (normalized == full) return true;
+    const std::string suffix = "sort";
+    return full.size() > suffix.size() && full.ends_with(suffix) &&
+           normalized == full.substr(0, full.size() - suffix.size());
+}
+
+template <typename T>
+T parseNumber(const std::string& flag, const std::string& text) {
+    T value{};
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size()) {
+        throw std::invalid_argument(flag + (std::is_integral_v<T> ? " 需要非负整数" : " 需要数值") + "，收到 \"" + text + "\"");
+    }
+    return value;
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find(',', begin);
+        if (end == std::string::npos) end = text.size();
+        if (end > begin) items.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return items;
+}
+
+std::vector<SortAlgorithm> parseAlgorithmList(const std::string& text) {
+    if (normalizeName(text) == "all") return {kAllSortAlgorithms.begin(), kAllSortAlgorithms.end()};
+    std::vector<SortAlgorithm> algorithms;
+    for (const std::string& item : splitList(text)) {
+        auto algorithm = parseSortAlgorithm(item);
+        if (!algorithm) throw std::invalid_argument("未知的排序算法 \"" + item + "\"");
+        algorithms.push_back(*algorithm);
+    }
+    return algorithms;
+}
+
+std::vector<DataPattern> parsePatternList(const std::string& text) {
+    if (normalizeName(text) == "all") return {kAllDataPatterns.begin(), kAllDataPatterns.end()};
+    std::vector<DataPattern> patterns;
+    for (const std::string& item : splitList(text)) {
+        auto pattern = parseDataPattern(item);
+        if (!pattern) throw std::invalid_argument("未知的数据模式 \"" + item + "\"");
+        patterns.push_back(*pattern);
+    }
+    return patterns;
+}
+
+template <typename T>
+void writeGeneratedDataset(const std::string& path, size_t size, DataPattern pattern, const PatternParams& params,
+                           uint64_t seed, size_t threadCount) {
+    ThreadPool pool(threadCount);
+    std::vector<T> values = generatePatternData<T>(size, pattern, params, seed, &pool);
+    writeDataset<T>(path, values);
+}
+
+int generateDatasetFile(const CliOptions& options) {
+    const BenchmarkConfig& config = options.benchmark;
+    size_t size = config.sizes.front();
+    DataPattern pattern = config.patterns.front();
+    uint64_t seed = config.seed ? *config.seed : randomSeed();
+    try {
+        if (options.keyType == "int64") {
+            writeGeneratedDataset<int64_t>(options.generatePath, size, pattern, config.patternParams, seed, config.threadCount);
+        } else {
+            writeGeneratedDataset<int32_t>(options.generatePath, size, pattern, config.patternParams, seed, config.threadCount);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "错误: " << e.what() << std::endl;
+        return 1;
+    }
+    if (!options.quiet) {
+        std::cerr << "已生成 " << options.generatePath << "（" << dataPatternName(pattern) << "，" << size << " 个 "
+                  << options.keyType << "，种子 " << seed << "）" << std::endl;
+    }
+    return 0;
+}
+
+// 专项实验：算法取 --algorithms 的第一个，回放类实验的数据按第一个模式和规模生成
+int runExperiment(const CliOptions& options, std::ostream& out) {
+    const BenchmarkConfig& config = options.benchmark;
+    const std::string& name = options.experiment;
+    SortAlgorithm algorithm = config.algorithms.front();
+    try {
+        if (name == "instrumentation") {
+            runInstrumentationBenchmark(out, config.sizes);
+        } else if (name == "parallel-speedup") {
+            for (size_t size : config.sizes) runParallelSpeedupBenchmark(out, size);
+        } else if (name == "sorting-network") {
+            runSortingNetworkBenchmark(out);
+        } else if (name == "heap-arity") {
+            runHeapArityBenchmark(out, config.sizes);
+        } else if (name == "incremental-render") {
+            runIncrementalRenderBenchmark(out, algorithm, options.speed, config.sizes);
+        } else {
+            uint64_t seed = config.seed ? *config.seed : randomSeed();
+            ThreadPool pool(config.threadCount);
+            std::vector<int> input = SortingSystem::generateTestData(config.sizes.front(), config.patterns.front(),
+                                                                     seed, &pool, config.patternParams);
+            if (name == "trace") runTraceRecording(out, algorithm, input);
+            else runReplaySimulation(out, algorithm, input, options.framesPerSecond, options.speed);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "错误: " << e.what() << std::endl;
+        return 1;
+    }
+    out.flush();
+    if (!out) {
+        std::cerr << "写入输出失败" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+std::optional<SortAlgorithm> parseSortAlgorithm(const std::string& name) {
+    std::string normalized = normalizeName(name);
+    for (SortAlgorithm algorithm : kAllSortAlgorithms) {
+        if (matchesName(normalized, sortAlgorithmName(algorithm))) return algorithm;
+    }
+    if (normalized == "radixlsd") return SortAlgorithm::RadixSortLSD;
+    if (normalized == "radixmsd") return SortAlgorithm::RadixSortMSD;
+    if (normalized == "timsort") return SortAlgorithm::PowerSort;
+    return std::nullopt;
+}
+
+std::optional<DataPattern> parseDataPattern(const std::string& name) {
+    std::string normalized = normalizeName(name);
+    for (DataPattern pattern : kAllDataPatterns) {
+        if (normalized == normalizeName(dataPatternName(pattern))) return pattern;
+    }
+    if (normalized == "sorted") return DataPattern::Ascending;
+    if (normalized == "reversed" || normalized == "reverse") return DataPattern::Descending;
+    if (normalized == "partial") return DataPattern::PartiallySorted;
+    if (normalized == "zipf") return DataPattern::Zipfian;
+    if (normalized == "gauss" || normalized == "normal") return DataPattern::Gaussian;
+    if (normalized == "runs") return DataPattern::SortedRuns;
+    if (normalized == "wide") return DataPattern::WideRange;
+    return std::nullopt;
+}
+
+CliOptions parseCliOptions(int argc, char* argv[]) {
+    CliOptions options;
+    BenchmarkConfig& config = options.benchmark;
+
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        std::string value;
+        bool hasInlineValue = false;
+        if (size_t eq = flag.find('='); flag.starts_with("--") && eq != std::string::npos) {
+            value = flag.substr(eq + 1);
+            flag = flag.substr(0, eq);
+            hasInlineValue = true;
+        }
+
+        // 无参数的开关
+        if (flag == "--help" || flag == "-h") { options.showHelp = true; continue; }
+        if (flag == "--quiet" || flag == "-q") { options.quiet = true; continue; }
+        if (flag == "--no-counters") { config.collectCounters = false; continue; }
+        if (flag == "--no-hw-counters") { config.collectHardwareCounters = false; continue; }
+        if (flag == "--no-stability") { config.checkStability = false; continue; }
+
+        if (!hasInlineValue) {
+            if (i + 1 >= argc) throw std::invalid_argument(flag + " 缺少参数值");
+            value = argv[++i];
+        }
+
+        if (flag == "--algorithms" || flag == "--algorithm" || flag == "-a") {
+            config.algorithms = parseAlgorithmList(value);
+        } else if (flag == "--patterns" || flag == "--pattern" || flag == "-p") {
+            config.patterns = parsePatternList(value);
+        } else if (flag == "--sizes" || flag == "--size" || flag == "-n") {
+            config.sizes.clear();
+            for (const std::string& item : splitList(value)) config.sizes.push_back(parseNumber<size_t>(flag, item));
+        } else if (flag == "--element-bytes" || flag == "-e") {
+            config.elementSizes.clear();
+            for (const std::string& item : splitList(value)) {
+                size_t bytes = parseNumber<size_t>(flag, item);
+                if (!BenchmarkRunner::isSupportedElementSize(bytes)) {
+                    throw std::invalid_argument(flag + " 只支持 4 / 8 / 16 / 64，收到 \"" + item + "\"");
+                }
+                config.elementSizes.push_back(bytes);
+            }
+        } else if (flag == "--strategy" || flag == "--strategies") {
+            config.strategies.clear();
+            for (const std::string& item : splitList(value)) {
+                if (item == "direct") config.strategies.push_back(SortStrategy::Direct);
+                else if (item == "argsort" || item == "indirect") config.strategies.push_back(SortStrategy::Argsort);
+                else if (item == "argsort-inplace") config.strategies.push_back(SortStrategy::ArgsortInPlace);
+                else throw std::invalid_argument(flag + " 只支持 direct / argsort / argsort-inplace，收到 \"" + item + "\"");
+            }
+        } else if (flag == "--reps" || flag == "--trials" || flag == "-r") {
+            config.trials = std::max(parseNumber<int>(flag, value), 1);
+        } else if (flag == "--warmup" || flag == "-w") {
+            config.warmupRuns = parseNumber<int>(flag, value);
+        } else if (flag == "--threads" || flag == "-t") {
+            config.threadCount = parseNumber<size_t>(flag, value);
+        } else if (flag == "--seed" || flag == "-s") {
+            config.seed = parseNumber<uint64_t>(flag, value);
+        } else if (flag == "--input" || flag == "-i") {
+            config.inputPath = value;
+        } else if (flag == "--partial-fraction") {
+            config.patternParams.partialFraction = parseNumber<double>(flag, value);
+        } else if (flag == "--unique") {
+            config.patternParams.uniqueCount = parseNumber<uint64_t>(flag, value);
+        } else if (flag == "--zipf-exponent") {
+            config.patternParams.zipfExponent = parseNumber<double>(flag, value);
+        } else if (flag == "--zipf-universe") {
+            config.patternParams.zipfUniverse = parseNumber<uint64_t>(flag, value);
+        } else if (flag == "--gaussian-stddev") {
+            config.patternParams.gaussianStddev = parseNumber<double>(flag, value);
+        } else if (flag == "--sawtooth-period") {
+            config.patternParams.sawtoothPeriod = parseNumber<uint64_t>(flag, value);
+        } else if (flag == "--displacement") {
+            config.patternParams.displacement = parseNumber<uint64_t>(flag, value);
+        } else if (flag == "--run-length") {
+            config.patternParams.runLength = parseNumber<uint64_t>(flag, value);
+        } else if (flag == "--generate") {
+            options.generatePath = value;
+        } else if (flag == "--key-type") {
+            if (value != "int32" && value != "int64") {
+                throw std::invalid_argument("--key-type 只支持 int32 / int64，收到 \"" + value + "\"");
+            }
+            options.keyType = value;
+        } else if (flag == "--experiment" || flag == "-x") {
+            if (std::find_if(std::begin(kCliExperiments), std::end(kCliExperiments),
+                             [&](const char* name) { return value == name; }) == std::end(kCliExperiments)) {
+                throw std::invalid_argument("未知的实验 \"" + value + "\"");
+            }
+            options.experiment = value;
+        } else if (flag == "--fps") {
+            options.framesPerSecond = parseNumber<double>(flag, value);
+            if (!(options.framesPerSecond > 0)) throw std::invalid_argument("--fps 必须大于 0");
+        } else if (flag == "--speed") {
+            options.speed = parseNumber<double>(flag, value);
+            if (!(options.speed > 0)) throw std::invalid_argument("--speed 必须大于 0");
+        } else if (flag == "--heap-arity") {
+            int arity = parseNumber<int>(flag, value);
+            if (!isSupportedHeapArity(arity)) {
+                throw std::invalid_argument(flag + " 只支持 2 / 4 / 8，收到 \"" + value + "\"");
+            }
+            setDefaultHeapArity(arity);
+        } else if (flag == "--quadratic-limit") {
+            config.quadraticSizeLimit = parseNumber<size_t>(flag, value);
+        } else if (flag == "--format" || flag == "-f") {
+            if (value != "table" && value != "json" && value != "csv") {
+                throw std::invalid_argument("--format 只支持 table / json / csv，收到 \"" + value + "\"");
+            }
+            options.format = value;
+        } else if (flag == "--output" || flag == "-o") {
+            options.outputPath = value;
+        } else {
+            throw std::invalid_argument("未知参数 " + flag);
+        }
+    }
+
+    if (config.algorithms.empty()) throw std::invalid_argument("--algorithms 不能为空");
+    if (config.elementSizes.empty()) throw std::invalid_argument("--element-bytes 不能为空");
+    if (config.strategies.empty()) throw std::invalid_argument("--strategy 不能为空");
+    if (config.inputPath.empty() && (config.patterns.empty() || config.sizes.empty())) {
+        throw std::invalid_argument("--patterns 与 --sizes 不能为空");
+    }
+    return options;
+}
+
+void printCliUsage(std::ostream& out, const char* program) {
+    out << "用法: " << program << " [选项]    （不带参数时进入交互菜单）\n"
+        << "\n"
+        << "  -a, --algorithms LIST     逗号分隔的算法，或 all（默认）。可用名称:\n"
+        << "                            ";
+    for (size_t i = 0; i < kAllSortAlgorithms.size(); i++) {
+        out << (i == 0 ? "" : ", ") << sortAlgorithmName(kAllSortAlgorithms[i]);
+    }
+    out << "\n"
+        << "                            大小写、空格、'-' 与末尾的 Sort 可省略，如 pdq,parallel-merge,lsd-radix\n"
+        << "  -p, --patterns LIST       逗号分隔的数据分布，或 all。可用名称:\n"
+        << "                            ";
+    for (size_t i = 0; i < kAllDataPatterns.size(); i++) {
+        out << (i == 0 ? "" : ", ") << dataPatternName(kAllDataPatterns[i]);
+    }
+    out << "\n"
+        << "  -n, --sizes LIST          数据规模，如 1000,10000,100000\n"
+        << "  -e, --element-bytes LIST  元素宽度：4 为 int（默认），8/16/64 为带原始下标的记录（逐次检查稳定性）\n"
+        << "      --strategy LIST       direct（默认，直接搬移元素）/ argsort（对键和下标排序后借助暂存按排列重排）\n"
+        << "                            / argsort-inplace（同 argsort，但不用暂存、沿置换的环原地重排）\n"
+        << "  -r, --reps N              每个单元格的计时次数（默认 10）\n"
+        << "  -w, --warmup N            预热次数（默认 2）\n"
+        << "  -t, --threads N           并行算法的线程数，0 为硬件并发数（默认）\n"
+        << "  -s, --seed N              数据生成种子，固定后结果可复现\n"
+        << "  -i, --input PATH          以 int32 数据集文件为输入（忽略 --patterns 与 --sizes）\n"
+        << "      --partial-fraction X  PartiallySorted 末尾打乱的比例（默认 0.3）\n"
+        << "      --unique N            FewUnique 的不同值个数（默认 16）\n"
+        << "      --zipf-exponent X     Zipfian 的指数 s（默认 1.0）\n"
+        << "      --zipf-universe N     Zipfian 的键空间大小，0 为数据量（默认）\n"
+        << "      --gaussian-stddev X   Gaussian 的标准差与数据量之比（默认 0.1）\n"
+        << "      --sawtooth-period N   Sawtooth 的周期（默认 1024）\n"
+        << "      --displacement K      KSorted 的最大位移（默认 16）\n"
+        << "      --run-length N        SortedRuns 的段长（默认 1024）\n"
+        << "      --generate PATH       不跑基准测试，按第一个模式和规模生成数据集文件\n"
+        << "      --key-type TYPE       --generate 的键类型：int32（默认）/ int64\n"
+        << "  -x, --experiment NAME     不跑基准测试矩阵，改为运行一项专项实验（文本表格输出，忽略 --format）:\n"
+        << "                            ";
+    for (size_t i = 0; i < std::size(kCliExperiments); i++) out << (i == 0 ? "" : ", ") << kCliExperiments[i];
+    out << "\n"
+        << "                            instrumentation / heap-arity / incremental-render 按 --sizes 的各个规模，\n"
+        << "                            parallel-speedup 对每个规模测各线程数；trace / replay-simulation 在第一个模式\n"
+        << "                            和规模的数据上运行；实验用到的算法取 --algorithms 的第一个\n"
+        << "      --fps X               replay-simulation 的目标帧率（默认 60）\n"
+        << "      --speed X             回放速度倍数，1 为每秒 1000 个事件（默认 1）\n"
+        << "      --heap-arity N        堆排序（及内省/pdq 排序退化时）使用的 2 / 4 / 8 叉堆（默认 4）\n"
+        << "      --quadratic-limit N   超过该规模时跳过 O(n²) 情形（默认 20000）\n"
+        << "      --no-counters         不额外运行计数插桩（比较/交换次数为 0）\n"
+        << "      --no-hw-counters      不读取硬件性能计数器\n"
+        << "      --no-stability        不实测各算法的稳定性\n"
+        << "  -f, --format FMT          table（默认）/ json / csv\n"
+        << "  -o, --output PATH         输出文件，默认标准输出\n"
+        << "  -q, --quiet               json/csv 模式下不在标准错误上输出进度\n"
+        << "  -h, --help                显示本帮助\n";
+}
+
+int runCli(int argc, char* argv[]) {
+    CliOptions options;
+    try {
+        options = parseCliOptions(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "参数错误: " << e.what() << "\n使用 --help 查看用法。" << std::endl;
+        return 2;
+    }
+    if (options.showHelp) {
+        printCliUsage(std::cout, argv[0]);
+        return 0;
+    }
+
+    if (!options.generatePath.empty()) {
+        return generateDatasetFile(options);
+    }
+
+    std::ofstream file;
+    if (!options.outputPath.empty()) {
+        file.open(options.outputPath);
+        if (!file) {
+            std::cerr << "无法写入 " << options.outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = options.outputPath.empty() ? std::cout : file;
+
+    if (!options.experiment.empty()) {
+        return runExperiment(options, out);
+    }
+
+    // 表格格式直接逐行输出；json/csv 在结束后整体写出，运行中的进度写到标准错误
+    bool table = options.format == "table";
+    std::ostream* progress = table ? &out : (options.quiet ? nullptr : &std::cerr);
+
+    try {
+        BenchmarkRunner runner(options.benchmark);
+        if (progress) {
+            BenchmarkRunner::writeTableHeader(*progress);
+            if (options.benchmark.collectHardwareCounters && !runner.hardwareCounters().available()) {
+                std::cerr << "（硬件计数器不可用：" << runner.hardwareCounters().unavailableReason() << "）" << std::endl;
+            }
+        }
+
+        std::vector<BenchmarkResult> results = runner.run([&](const BenchmarkResult& r) {
+            if (progress) BenchmarkRunner::writeTableRow(*progress, r);
+        });
+
+        if (options.format == "json") runner.writeJson(out, results);
+        else if (options.format == "csv") runner.writeCsv(out, results);
+        out.flush();
+        if (!out) {
+            std::cerr << "写入输出失败" << std::endl;
+            return 1;
+        }
+
+        for (const BenchmarkResult& r : results) {
+            if (!r.verified) {
+                std::cerr << "排序结果校验失败: " << sortAlgorithmName(r.algorithm) << std::endl;
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "错误: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include "benchmark.h"
+
+// 无交互的命令行前端：一次运行一个完整的基准测试矩阵，适合批处理与脚本调用。
+//   12_15 --algorithms pdq,merge --patterns random,ascending --sizes 10000,100000
+//         --reps 10 --warmup 2 --threads 8 --seed 42 --format json --output result.json
+// 参数既可写作 "--flag value"，也可写作 "--flag=value"。
+// 给出 --experiment 时改为运行一项专项实验（见 sort_benchmarks.h / replay_experiments.h），以文本表格输出：
+//   12_15 --experiment replay-simulation -a merge -p random -n 100000 --fps 60 --speed 50
+
+struct CliOptions {
+    BenchmarkConfig benchmark;
+    std::string format = "table"; // table / json / csv
+    std::string outputPath;       // 为空时写到标准输出
+    bool quiet = false;           // 不在标准错误上输出进度
+    bool showHelp = false;
+    // 非空时不跑基准测试，而是按第一个模式和规模生成数据集文件（dataset_io.h）
+    std::string generatePath;
+    std::string keyType = "int32"; // 生成数据集的键类型：int32 / int64
+    // 非空时不跑基准测试矩阵，而是运行该名称的专项实验（kCliExperiments）
+    std::string experiment;
+    double framesPerSecond = 60.0; // 回放实验的目标帧率
+    double speed = 1.0;            // 回放实验的速度倍数：1 为每秒 1000 个事件
+};
+
+// --experiment 可用的名称
+inline constexpr const char* kCliExperiments[] = {
+    "instrumentation", "parallel-speedup", "sorting-network", "heap-arity",
+    "trace", "replay-simulation", "incremental-render"
+};
+
+// 按名称查找算法/数据模式：不区分大小写，忽略空格、'-'、'_'，
+// 可省略末尾的 "sort"（如 "pdq"、"parallel-merge"、"LSD Radix Sort"）
+std::optional<SortAlgorithm> parseSortAlgorithm(const std::string& name);
+std::optional<DataPattern> parseDataPattern(const std::string& name);
+
+// 参数有误时抛出 std::invalid_argument
+CliOptions parseCliOptions(int argc, char* argv[]);
+void printCliUsage(std::ostream& out, const char* program);
+
+// 返回进程退出码：0 成功；1 运行出错或排序结果校验失败；2 参数错误
+int runCli(int argc, char* argv[]);
+
+#endif // CLI_H
@@ -0,0 +1,377 @@
+#ifndef DATA_GENERATOR_H
+#define DATA_GENERATOR_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+
+// 计数器式（无状态）随机数据生成
+// 第 i 个输出只取决于 (seed, i)，不依赖之前生成过什么，因此可以任意切块并行填充，
+// 同一种子在任何线程数下得到逐位相同的数据。
+
+// splitmix64 的混合函数：对相邻的输入也能给出统计上独立的输出
+constexpr uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// 未指定种子时使用的随机种子
+inline uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+class CounterRng {
+public:
+    // stream 用于从同一种子派生互不相关的序列
+    constexpr explicit CounterRng(uint64_t seed, uint64_t stream = 0)
+        : key(splitMix64(seed ^ splitMix64(stream))) {}
+
+    constexpr uint64_t operator()(uint64_t counter) const { return splitMix64(key + counter * kGamma); }
+
+    // [0, bound) 内的值（乘法取高位，偏差可忽略）
+    uint64_t below(uint64_t counter, uint64_t bound) const {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>((*this)(counter)) * bound) >> 64);
+    }
+
+    // [0, 1) 内的 double
+    double uniform(uint64_t counter) const { return static_cast<double>((*this)(counter) >> 11) * 0x1.0p-53; }
+
+private:
+    static constexpr uint64_t kGamma = 0x9E3779B97F4A7C15ull;
+    uint64_t key;
+};
+
+// [0, n) 上的伪随机排列 π，可以直接算出任意 π(i)，用于代替 std::shuffle
+// 在 2^bits ≥ n（bits 取最小值，2^bits < 2n）的定义域上做 4 轮 Feistel 加密；bits 为奇数时
+// 左右两半相差一位（非平衡 Feistel），每一轮仍是双射。结果落在 [n, 2^bits) 时继续加密
+// 直到回到 [0, n)（cycle walking），整体仍是双射，平均每个元素不超过 2 次加密。
+class RandomPermutation {
+public:
+    RandomPermutation(uint64_t n, uint64_t seed) : n(n) {
+        unsigned bits = n <= 2 ? 2 : static_cast<unsigned>(std::bit_width(n - 1));
+        leftBits = bits / 2;
+        rightBits = bits - leftBits;
+        CounterRng rng(seed, kStream);
+        for (size_t r = 0; r < kRounds; r++) roundKeys[r] = rng(r);
+    }
+
+    uint64_t size() const { return n; }
+
+    uint64_t operator()(uint64_t index) const {
+        uint64_t x = index;
+        do {
+            x = encrypt(x);
+        } while (x >= n);
+        return x;
+    }
+
+private:
+    static constexpr size_t kRounds = 4; // 偶数轮后左右两半的位宽回到初始状态
+    static constexpr uint64_t kStream = 0x7065726D; // "perm"
+
+    uint64_t n;
+    unsigned leftBits;
+    unsigned rightBits;
+    uint64_t roundKeys[kRounds];
+
+    static uint64_t lowBits(uint64_t x, unsigned bits) { return x & ((uint64_t(1) << bits) - 1); }
+
+    // 轮函数：两次乘法混合后取高 32 位（每半最多 32 位）
+    static uint64_t roundFunction(uint64_t x, uint64_t key) {
+        x = (x ^ key) * 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 31;
+        x *= 0x94D049BB133111EBull;
+        return x >> 32;
+    }
+
+    uint64_t encrypt(uint64_t x) const {
+        unsigned lb = leftBits, rb = rightBits;
+        uint64_t left = x >> rb;
+        uint64_t right = lowBits(x, rb);
+        for (uint64_t key : roundKeys) {
+            // (L, R) -> (R, L ^ F(R))，两半的位宽随之交换
+            uint64_t next = lowBits(left ^ roundFunction(right, key), lb);
+            left = right;
+            right = next;
+            std::swap(lb, rb);
+        }
+        return (left << rb) | right;
+    }
+};
+
+// 把 [0, count) 切成长度为 grain 的块并行执行 fn(begin, end)；
+// 切块方式固定，只要 fn 对不同块互不干扰，结果就与线程数无关
+template <typename Fn>
+void parallelForRanges(size_t count, size_t grain, Fn fn, ThreadPool* pool = nullptr) {
+    grain = std::max<size_t>(grain, 1);
+    if (pool == nullptr || pool->getThreadCount() == 1 || count <= grain) {
+        if (count > 0) fn(size_t(0), count);
+        return;
+    }
+
+    TaskGroup group(*pool);
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = std::min(begin + grain, count);
+        group.run([&fn, begin, end] { fn(begin, end); });
+    }
+    group.wait();
+}
+
+// 并行填充 out[i] = fn(i)；fn 只能依赖 i，因此结果与线程数和切块方式无关。
+// pool 为空或数据量较小时在当前线程完成。
+inline constexpr size_t kGenerateChunkSize = size_t(1) << 16;
+
+template <typename T, typename Fn>
+void parallelGenerate(std::span<T> out, Fn fn, ThreadPool* pool = nullptr) {
+    parallelForRanges(out.size(), kGenerateChunkSize, [out, &fn](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) out[i] = fn(static_cast<uint64_t>(i));
+    }, pool);
+}
+
+// Zipf 分布：P(k) ∝ 1 / k^s，k ∈ [1, n]
+// 采用 Hörmann & Derflinger 的拒绝-反演采样，O(1) 期望时间且不需要 O(n) 的累积分布表；
+// 每次尝试消耗一个均匀随机数，接受率通常在 90% 以上。
+class ZipfDistribution {
+public:
+    ZipfDistribution(uint64_t n, double exponent) : n(std::max<uint64_t>(n, 1)), s(exponent) {
+        hIntegralX1 = hIntegral(1.5) - 1.0;
+        hIntegralN = hIntegral(static_cast<double>(this->n) + 0.5);
+        threshold = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
+
+    // uniform 返回 [0, 1) 内的第 attempt 个均匀随机数
+    template <typename Uniform>
+    uint64_t sample(Uniform uniform) const {
+        for (uint64_t attempt = 0;; attempt++) {
+            double u = hIntegralN + uniform(attempt) * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            double k = std::clamp(std::floor(x + 0.5), 1.0, static_cast<double>(n));
+            if (k - x <= threshold || u >= hIntegral(k + 0.5) - h(k)) return static_cast<uint64_t>(k);
+        }
+    }
+
+private:
+    uint64_t n;
+    double s;
+    double hIntegralX1;
+    double hIntegralN;
+    double threshold;
+
+    // (exp(x) - 1) / x 与 log(1 + x) / x，在 x → 0 时用泰勒展开避免抵消误差
+    static double expm1OverX(double x) {
+        return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+    }
+    static double log1pOverX(double x) {
+        return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+
+    double h(double x) const { return std::exp(-s * std::log(x)); }
+    // ∫ h = (x^(1-s) - 1) / (1 - s)，s = 1 时为 log(x)
+    double hIntegral(double x) const {
+        double logX = std::log(x);
+        return expm1OverX((1.0 - s) * logX) * logX;
+    }
+    double hIntegralInverse(double x) const {
+        double t = std::max(x * (1.0 - s), -1.0);
+        return std::exp(log1pOverX(t) * x);
+    }
+};
+
+// 测试数据的分布
+enum class DataPattern {
+    Random,          // 1..n 的随机排列
+    Ascending,
+    Descending,
+    PartiallySorted, // 前段有序，末尾 partialFraction 打乱
+    FewUnique,       // 只有 uniqueCount 个不同的值
+    Zipfian,         // Zipf 偏斜：少数键出现极多次
+    Gaussian,        // 正态分布，中间值大量重复
+    OrganPipe,       // 先升后降
+    Sawtooth,        // 周期为 sawtoothPeriod 的升序锯齿
+    KSorted,         // 每个元素离最终位置不超过 displacement
+    SortedRuns,      // 长度为 runLength 的有序段拼接
+    WideRange        // 均匀覆盖键类型的整个取值范围（含负数）
+};
+
+inline constexpr std::array<DataPattern, 12> kAllDataPatterns = {
+    DataPattern::Random,
+    DataPattern::Ascending,
+    DataPattern::Descending,
+    DataPattern::PartiallySorted,
+    DataPattern::FewUnique,
+    DataPattern::Zipfian,
+    DataPattern::Gaussian,
+    DataPattern::OrganPipe,
+    DataPattern::Sawtooth,
+    DataPattern::KSorted,
+    DataPattern::SortedRuns,
+    DataPattern::WideRange
+};
+
+inline const char* dataPatternName(DataPattern pattern) {
+    switch (pattern) {
+        case DataPattern::Random:          return "Random";
+        case DataPattern::Ascending:       return "Ascending";
+        case DataPattern::Descending:      return "Descending";
+        case DataPattern::PartiallySorted: return "PartiallySorted";
+        case DataPattern::FewUnique:       return "FewUnique";
+        case DataPattern::Zipfian:         return "Zipfian";
+        case DataPattern::Gaussian:        return "Gaussian";
+        case DataPattern::OrganPipe:       return "OrganPipe";
+        case DataPattern::Sawtooth:        return "Sawtooth";
+        case DataPattern::KSorted:         return "KSorted";
+        case DataPattern::SortedRuns:      return "SortedRuns";
+        case DataPattern::WideRange:       return "WideRange";
+    }
+    return "Unknown";
+}
+
+// 各分布的参数，未用到的字段被忽略
+struct PatternParams {
+    double partialFraction = 0.3;  // PartiallySorted：末尾打乱的比例
+    uint64_t uniqueCount = 16;     // FewUnique：不同值的个数
+    double zipfExponent = 1.0;     // Zipfian：指数 s（> 0，越大越偏斜）
+    uint64_t zipfUniverse = 0;     // Zipfian：可能出现的键数，0 表示与数据量相同
+    double gaussianStddev = 0.1;   // Gaussian：标准差与数据量之比，均值为 n / 2
+    uint64_t sawtoothPeriod = 1024;
+    uint64_t displacement = 16;    // KSorted：最大位移 k
+    uint64_t runLength = 1024;     // SortedRuns：每段长度
+};
+
+// 生成 size 个 T 类型的键。除 WideRange 外取值都在 [1, size] 附近，
+// 同一 (pattern, params, seed) 在任何线程数下生成逐位相同的数据。
+template <typename T>
+std::vector<T> generatePatternData(size_t size, DataPattern pattern, const PatternParams& params, uint64_t seed,
+                                   ThreadPool* pool = nullptr) {
+    static_assert(std::is_integral_v<T>, "generatePatternData 只支持整数键");
+    std::vector<T> values(size);
+    std::span<T> out(values);
+    CounterRng rng(seed, static_cast<uint64_t>(pattern));
+    auto key = [](uint64_t value) { return static_cast<T>(value); };
+
+    switch (pattern) {
+        case DataPattern::Random: {
+            RandomPermutation permutation(size, seed);
+            parallelGenerate(out, [&](uint64_t i) { return key(permutation(i) + 1); }, pool);
+            break;
+        }
+
+        case DataPattern::Ascending:
+            parallelGenerate(out, [&](uint64_t i) { return key(i + 1); }, pool);
+            break;
+
+        case DataPattern::Descending:
+            parallelGenerate(out, [&](uint64_t i) { return key(size - i); }, pool);
+            break;
+
+        case DataPattern::PartiallySorted: {
+            double fraction = std::clamp(params.partialFraction, 0.0, 1.0);
+            size_t unsortedSize = size > 10 ? static_cast<size_t>(static_cast<double>(size) * fraction) : 0;
+            size_t sortedSize = size - unsortedSize;
+            RandomPermutation permutation(unsortedSize, seed);
+            parallelGenerate(out, [&](uint64_t i) {
+                return key(i < sortedSize ? i + 1 : sortedSize + permutation(i - sortedSize) + 1);
+            }, pool);
+            break;
+        }
+
+        case DataPattern::FewUnique: {
+            uint64_t unique = std::max<uint64_t>(params.uniqueCount, 1);
+            parallelGenerate(out, [&](uint64_t i) { return key(rng.below(i, unique) + 1); }, pool);
+            break;
+        }
+
+        case DataPattern::Zipfian: {
+            // 按频率排名 k 采样后再经随机排列映射成键，高频键不会总是最小的几个值
+            uint64_t universe = params.zipfUniverse > 0 ? params.zipfUniverse : std::max<size_t>(size, 1);
+            ZipfDistribution zipf(universe, std::max(params.zipfExponent, 1e-6));
+            RandomPermutation rankToKey(universe, seed);
+            parallelGenerate(out, [&](uint64_t i) {
+                // 第 attempt 次尝试使用计数器 i + attempt * size，不同位置、不同尝试互不重复
+                uint64_t rank = zipf.sample([&](uint64_t attempt) { return rng.uniform(i + attempt * size); });
+                return key(rankToKey(rank - 1) + 1);
+            }, pool);
+            break;
+        }
+
+        case DataPattern::Gaussian: {
+            // Box-Muller 变换，结果截断到 T 的取值范围。64 位类型的最大值换成 double 会进位成 2^63（2^64），
+            // 因此先在 double 上比较边界、直接返回边界值，只有落在范围内的值才转换
+            double mean = static_cast<double>(size) / 2.0;
+            double stddev = params.gaussianStddev * static_cast<double>(size);
+            double lowest = static_cast<double>(std::numeric_limits<T>::lowest());
+            double highest = static_cast<double>(std::numeric_limits<T>::max());
+            parallelGenerate(out, [&](uint64_t i) {
+                double u1 = 1.0 - rng.uniform(2 * i);  // (0, 1]，避免 log(0)
+                double u2 = rng.uniform(2 * i + 1);
+                double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * std::numbers::pi * u2);
+                double value = std::round(mean + stddev * z);
+                if (value <= lowest) return std::numeric_limits<T>::lowest();
+                if (value >= highest) return std::numeric_limits<T>::max();
+                return static_cast<T>(value);
+            }, pool);
+            break;
+        }
+
+        case DataPattern::OrganPipe: {
+            size_t half = (size + 1) / 2;
+            parallelGenerate(out, [&](uint64_t i) { return key(i < half ? i + 1 : size - i); }, pool);
+            break;
+        }
+
+        case DataPattern::Sawtooth: {
+            uint64_t period = std::max<uint64_t>(params.sawtoothPeriod, 1);
+            parallelGenerate(out, [&](uint64_t i) { return key(i % period + 1); }, pool);
+            break;
+        }
+
+        case DataPattern::KSorted: {
+            // 每 k + 1 个位置为一块，块内随机排列：任何元素最多离开其有序位置 k 步
+            uint64_t block = params.displacement + 1;
+            parallelGenerate(out, [&](uint64_t i) {
+                uint64_t first = i - i % block;
+                uint64_t length = std::min<uint64_t>(block, size - first);
+                RandomPermutation permutation(length, seed ^ splitMix64(first));
+                return key(first + permutation(i - first) + 1);
+            }, pool);
+            break;
+        }
+
+        case DataPattern::SortedRuns: {
+            // 先生成随机排列，再把每段各自排好序；每段互不重叠，可以按段并行
+            RandomPermutation permutation(size, seed);
+            parallelGenerate(out, [&](uint64_t i) { return key(permutation(i) + 1); }, pool);
+            size_t runLength = static_cast<size_t>(std::max<uint64_t>(params.runLength, 1));
+            size_t runCount = (size + runLength - 1) / runLength;
+            size_t runsPerTask = std::max<size_t>(kGenerateChunkSize / runLength, 1);
+            parallelForRanges(runCount, runsPerTask, [&](size_t firstRun, size_t lastRun) {
+                for (size_t run = firstRun; run < lastRun; run++) {
+                    size_t begin = run * runLength;
+                    std::sort(out.begin() + begin, out.begin() + std::min(begin + runLength, size));
+                }
+            }, pool);
+            break;
+        }
+
+        case DataPattern::WideRange:
+            parallelGenerate(out, [&](uint64_t i) { return key(rng(i)); }, pool);
+            break;
+    }
+    return values;
+}
+
+#endif // DATA_GENERATOR_H
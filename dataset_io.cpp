@@ -0,0 +1,221 @@
+#include "dataset_io.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct FileCloser {
+    void operator()(std::FILE* file) const {
+        if (file) std::fclose(file);
+    }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+// 校验头部并确认文件长度与元素个数一致
+void validateHeader(const DatasetHeader& header, uint64_t fileBytes, const std::string& path) {
+    if (std::memcmp(header.magic, DatasetHeader::kMagic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("不是数据集文件: " + path);
+    }
+    if (header.version != DatasetHeader::kVersion) {
+        throw std::runtime_error("不支持的数据集版本 " + std::to_string(header.version) + ": " + path);
+    }
+    if (header.elementType < static_cast<uint32_t>(DatasetElementType::Int32) ||
+        header.elementType > static_cast<uint32_t>(DatasetElementType::Float64)) {
+        throw std::runtime_error("未知的元素类型 " + std::to_string(header.elementType) + ": " + path);
+    }
+    static constexpr uint32_t kElementSizes[] = {0, 4, 8, 4, 8, 4, 8};
+    if (header.elementSize != kElementSizes[header.elementType]) {
+        throw std::runtime_error("元素长度与元素类型不符: " + path);
+    }
+    // 版本 1 的数据区紧跟 64 字节的头部：映射基址按页对齐，数据区因此对任何元素类型都是对齐的。
+    // 其他偏移会让 elements<T>() 得到未对齐的 T*，一律拒绝
+    if (header.headerSize != sizeof(DatasetHeader)) {
+        throw std::runtime_error("不支持的头部长度 " + std::to_string(header.headerSize) + ": " + path);
+    }
+    if (fileBytes < header.headerSize ||
+        (fileBytes - header.headerSize) % header.elementSize != 0 ||
+        (fileBytes - header.headerSize) / header.elementSize != header.count) {
+        throw std::runtime_error("数据集文件长度与头部记录的元素个数不符: " + path);
+    }
+}
+
+} // namespace
+
+const char* datasetElementTypeName(DatasetElementType type) {
+    switch (type) {
+        case DatasetElementType::Int32:   return "int32";
+        case DatasetElementType::Int64:   return "int64";
+        case DatasetElementType::UInt32:  return "uint32";
+        case DatasetElementType::UInt64:  return "uint64";
+        case DatasetElementType::Float32: return "float32";
+        case DatasetElementType::Float64: return "float64";
+    }
+    return "unknown";
+}
+
+uint64_t datasetChecksum(const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0x6A09E667F3BCC908ull ^ bytes;
+
+    size_t words = bytes / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        std::memcpy(&word, p + i * 8, 8);
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+    }
+    for (size_t i = words * 8; i < bytes; i++) {
+        hash = (hash ^ p[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+DatasetHeader readDatasetHeader(const std::string& path) {
+    FilePtr file(std::fopen(path.c_str(), "rb"));
+    if (!file) throw std::runtime_error("无法打开文件: " + path);
+
+    DatasetHeader header;
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1) {
+        throw std::runtime_error("不是数据集文件: " + path);
+    }
+    validateHeader(header, std::filesystem::file_size(path), path);
+    return header;
+}
+
+MappedDataset::MappedDataset(const std::string& path, bool verifyChecksum) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("无法打开文件: " + path);
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) < sizeof(DatasetHeader)) {
+        CloseHandle(file);
+        throw std::runtime_error("不是数据集文件: " + path);
+    }
+    mappedBytes = static_cast<size_t>(fileSize.QuadPart);
+
+    // PAGE_WRITECOPY + FILE_MAP_COPY：写入时复制，等同于 POSIX 的 MAP_PRIVATE
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) throw std::runtime_error("无法映射文件: " + path);
+    base = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!base) {
+        CloseHandle(mapping);
+        throw std::runtime_error("无法映射文件: " + path);
+    }
+    mappingHandle = mapping;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("无法打开文件: " + path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(DatasetHeader)) {
+        ::close(fd);
+        throw std::runtime_error("不是数据集文件: " + path);
+    }
+    mappedBytes = static_cast<size_t>(info.st_size);
+
+    // 只读打开的文件也可以 MAP_PRIVATE 映射为可写：写入触发写时复制，不会写回文件
+    void* address = ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) throw std::runtime_error("无法映射文件: " + path);
+    base = address;
+    ::madvise(base, mappedBytes, MADV_WILLNEED);
+#endif
+
+    try {
+        validateHeader(header(), mappedBytes, path);
+        if (verifyChecksum) {
+            const char* payload = static_cast<const char*>(base) + header().headerSize;
+            if (datasetChecksum(payload, mappedBytes - header().headerSize) != header().checksum) {
+                throw std::runtime_error("数据集校验和不符，文件可能已损坏: " + path);
+            }
+        }
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+MappedDataset::~MappedDataset() {
+    unmap();
+}
+
+MappedDataset::MappedDataset(MappedDataset&& other) noexcept
+    : base(std::exchange(other.base, nullptr)), mappedBytes(std::exchange(other.mappedBytes, 0)) {
+#ifdef _WIN32
+    mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+}
+
+MappedDataset& MappedDataset::operator=(MappedDataset&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        base = std::exchange(other.base, nullptr);
+        mappedBytes = std::exchange(other.mappedBytes, 0);
+#ifdef _WIN32
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedDataset::unmap() {
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    mappingHandle = nullptr;
+#else
+    ::munmap(base, mappedBytes);
+#endif
+    base = nullptr;
+    mappedBytes = 0;
+}
+
+void writeDatasetBytes(const std::string& path, DatasetElementType type, uint32_t elementSize,
+                       const void* data, uint64_t count) {
+    DatasetHeader header{};
+    std::memcpy(header.magic, DatasetHeader::kMagic, sizeof(header.magic));
+    header.version = DatasetHeader::kVersion;
+    header.elementType = static_cast<uint32_t>(type);
+    header.elementSize = elementSize;
+    header.headerSize = sizeof(DatasetHeader);
+    header.count = count;
+    size_t payloadBytes = static_cast<size_t>(count * elementSize);
+    header.checksum = datasetChecksum(data, payloadBytes);
+
+    std::string tempPath = path + ".tmp";
+    {
+        FilePtr file(std::fopen(tempPath.c_str(), "wb"));
+        if (!file) throw std::runtime_error("无法创建文件: " + tempPath);
+        std::setvbuf(file.get(), nullptr, _IONBF, 0);
+
+        bool ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+        if (ok && payloadBytes > 0) ok = std::fwrite(data, 1, payloadBytes, file.get()) == payloadBytes;
+        if (ok) ok = std::fflush(file.get()) == 0;
+        if (!ok) {
+            file.reset();
+            std::filesystem::remove(tempPath);
+            throw std::runtime_error("写入文件失败: " + path);
+        }
+    }
+    std::filesystem::rename(tempPath, path);
+}
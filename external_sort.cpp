@@ -0,0 +1,357 @@
+#include "external_sort.h"
+#include "data_generator.h"
+#include "parallel_sort.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+using Key = ExternalSorter::Key;
+
+struct FileCloser {
+    void operator()(std::FILE* file) const {
+        if (file) std::fclose(file);
+    }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+// 读写都按整块缓冲区进行，关闭 stdio 自带的缓冲以免多一次拷贝
+FilePtr openFile(const std::string& path, const char* mode) {
+    FilePtr file(std::fopen(path.c_str(), mode));
+    if (!file) throw std::runtime_error("无法打开文件: " + path);
+    std::setvbuf(file.get(), nullptr, _IONBF, 0);
+    return file;
+}
+
+size_t readKeys(std::FILE* file, Key* buffer, size_t count, const std::string& path) {
+    if (count == 0) return 0;
+    size_t read = std::fread(buffer, sizeof(Key), count, file);
+    if (read < count && std::ferror(file)) throw std::runtime_error("读取文件失败: " + path);
+    return read;
+}
+
+void writeKeys(std::FILE* file, const Key* buffer, size_t count, const std::string& path) {
+    if (count == 0) return;
+    if (std::fwrite(buffer, sizeof(Key), count, file) != count) {
+        throw std::runtime_error("写入文件失败: " + path);
+    }
+}
+
+uint64_t keyCount(const std::string& path) {
+    uint64_t bytes = std::filesystem::file_size(path);
+    if (bytes % sizeof(Key) != 0) throw std::runtime_error("文件大小不是键长度的整数倍: " + path);
+    return bytes / sizeof(Key);
+}
+
+// 离开作用域时删除 files 中剩余的临时文件（异常退出时也不留下 .run 文件）
+class TempFileGuard {
+public:
+    explicit TempFileGuard(std::vector<std::string>& files) : files(files) {}
+    TempFileGuard(const TempFileGuard&) = delete;
+    TempFileGuard& operator=(const TempFileGuard&) = delete;
+    ~TempFileGuard() {
+        std::error_code ignored;
+        for (const auto& path : files) std::filesystem::remove(path, ignored);
+        files.clear();
+    }
+
+private:
+    std::vector<std::string>& files;
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 带缓冲地顺序读取一个有序段
+class RunReader {
+public:
+    RunReader(const std::string& path, size_t capacity) : path(path), file(openFile(path, "rb")), buffer(capacity) {
+        refill();
+    }
+
+    bool exhausted() const { return position == size; }
+    Key current() const { return buffer[position]; }
+    void advance() {
+        if (++position == size) refill();
+    }
+    uint64_t getBytesRead() const { return bytesRead; }
+
+private:
+    std::string path;
+    FilePtr file;
+    std::vector<Key> buffer;
+    size_t position = 0;
+    size_t size = 0;
+    uint64_t bytesRead = 0;
+
+    void refill() {
+        size = readKeys(file.get(), buffer.data(), buffer.size(), path);
+        position = 0;
+        bytesRead += size * sizeof(Key);
+    }
+};
+
+// 带缓冲地顺序写出归并结果
+class RunWriter {
+public:
+    RunWriter(const std::string& path, size_t capacity) : path(path), file(openFile(path, "wb")) {
+        buffer.reserve(capacity);
+    }
+
+    void push(Key key) {
+        buffer.push_back(key);
+        if (buffer.size() == buffer.capacity()) flush();
+    }
+    void finish() {
+        flush();
+        if (std::fflush(file.get()) != 0) throw std::runtime_error("写入文件失败: " + path);
+        file.reset();
+    }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    std::string path;
+    FilePtr file;
+    std::vector<Key> buffer;
+    uint64_t bytesWritten = 0;
+
+    void flush() {
+        writeKeys(file.get(), buffer.data(), buffer.size(), path);
+        bytesWritten += buffer.size() * sizeof(Key);
+        buffer.clear();
+    }
+};
+
+// 败者树：内部结点保存比赛的败者，tree[0] 为总冠军。
+// 冠军输出并前进后只需沿其叶子到根重赛一次，每个元素 ⌈log2 k⌉ 次比较。
+// 键相等时下标小的段获胜，段按输入顺序编号，因此归并是稳定的。
+class LoserTree {
+public:
+    explicit LoserTree(std::vector<RunReader>& readers) : readers(readers), tree(std::max<size_t>(readers.size(), 1)) {
+        tree[0] = build(1);
+    }
+
+    size_t winner() const { return tree[0]; }
+
+    // 冠军所在段前进一个元素后重新比赛
+    void replay() {
+        size_t k = readers.size();
+        size_t current = tree[0];
+        for (size_t node = (current + k) / 2; node >= 1; node /= 2) {
+            if (beats(tree[node], current)) std::swap(tree[node], current);
+        }
+        tree[0] = current;
+    }
+
+private:
+    std::vector<RunReader>& readers;
+    std::vector<size_t> tree;
+
+    // 结点 k..2k-1 为叶子（对应段 0..k-1），返回子树的冠军
+    size_t build(size_t node) {
+        size_t k = readers.size();
+        if (node >= k) return node - k;
+        size_t left = build(2 * node);
+        size_t right = build(2 * node + 1);
+        bool leftWins = beats(left, right);
+        tree[node] = leftWins ? right : left;
+        return leftWins ? left : right;
+    }
+
+    // 已读完的段视为无穷大
+    bool beats(size_t a, size_t b) const {
+        if (readers[a].exhausted()) return false;
+        if (readers[b].exhausted()) return true;
+        Key x = readers[a].current();
+        Key y = readers[b].current();
+        return x < y || (x == y && a < b);
+    }
+};
+
+} // namespace
+
+uint64_t ExternalSortStats::totalBytesRead() const {
+    uint64_t total = 0;
+    for (const auto& pass : passes) total += pass.bytesRead;
+    return total;
+}
+
+uint64_t ExternalSortStats::totalBytesWritten() const {
+    uint64_t total = 0;
+    for (const auto& pass : passes) total += pass.bytesWritten;
+    return total;
+}
+
+ExternalSorter::ExternalSorter(ExternalSortOptions options) : options(std::move(options)), tempToken(randomSeed()) {
+    if (isParallelSortAlgorithm(this->options.runAlgorithm) && !this->options.pool) {
+        throw std::invalid_argument(std::string("段内排序算法 ") + sortAlgorithmName(this->options.runAlgorithm) +
+                                    " 需要线程池");
+    }
+    if (this->options.tempDirectory.empty()) {
+        this->options.tempDirectory = std::filesystem::temp_directory_path().string();
+    }
+}
+
+void ExternalSorter::sortFile(const std::string& inputPath, const std::string& outputPath) {
+    if (std::filesystem::exists(outputPath) && std::filesystem::equivalent(inputPath, outputPath)) {
+        throw std::runtime_error("输入与输出不能是同一个文件: " + inputPath);
+    }
+
+    stats = ExternalSortStats();
+    stats.elements = keyCount(inputPath);
+
+    // 需要缓冲区的段内排序算法把预算平分给段与缓冲区
+    bool needsScratch = options.runAlgorithm == SortAlgorithm::MergeSort ||
+                        options.runAlgorithm == SortAlgorithm::ParallelMergeSort ||
+                        options.runAlgorithm == SortAlgorithm::PowerSort ||
+                        options.runAlgorithm == SortAlgorithm::RadixSortLSD;
+    stats.runElements = std::max<size_t>(options.memoryBudget / sizeof(Key) / (needsScratch ? 2 : 1), 1024);
+
+    size_t fanInByBudget = options.memoryBudget / kMinMergeBufferBytes;
+    fanInByBudget = fanInByBudget > 1 ? fanInByBudget - 1 : 0; // 留一块给输出
+    stats.fanIn = std::max<size_t>(std::min(options.maxFanIn, fanInByBudget), 2);
+
+    TempFileGuard guard(tempFiles);
+    std::vector<std::string> runs = createRuns(inputPath, outputPath);
+
+    // 归并阶段不再需要段缓冲区，释放后再按预算分配归并缓冲区
+    std::vector<Key>().swap(runBuffer);
+    std::vector<Key>().swap(scratchBuffer);
+
+    for (int passIndex = 1; runs.size() > 1; passIndex++) {
+        auto start = std::chrono::steady_clock::now();
+        ExternalSortPass pass{passIndex, runs.size(), 0, 0, 0, 0.0};
+        bool finalPass = runs.size() <= stats.fanIn;
+
+        std::vector<std::string> nextRuns;
+        for (size_t first = 0; first < runs.size(); first += stats.fanIn) {
+            size_t last = std::min(first + stats.fanIn, runs.size());
+            if (last - first == 1) {
+                // 剩下的单个段原样留到下一遍
+                nextRuns.push_back(runs[first]);
+                continue;
+            }
+            std::vector<std::string> group(runs.begin() + first, runs.begin() + last);
+            std::string target = finalPass ? outputPath : tempPath(passIndex, nextRuns.size());
+            if (!finalPass) tempFiles.push_back(target);
+            mergeRuns(group, target, pass);
+            for (const auto& path : group) {
+                std::filesystem::remove(path);
+                tempFiles.erase(std::find(tempFiles.begin(), tempFiles.end(), path));
+            }
+            nextRuns.push_back(target);
+        }
+
+        pass.outputRuns = nextRuns.size();
+        pass.timeTaken = elapsedMs(start);
+        stats.passes.push_back(pass);
+        runs = std::move(nextRuns);
+    }
+}
+
+// 第 0 遍：整个文件能放进一个段时直接写到输出，返回空列表
+std::vector<std::string> ExternalSorter::createRuns(const std::string& inputPath, const std::string& outputPath) {
+    auto start = std::chrono::steady_clock::now();
+    ExternalSortPass pass{0, 0, 0, 0, 0, 0.0};
+    std::vector<std::string> runs;
+
+    size_t capacity = static_cast<size_t>(std::min<uint64_t>(stats.elements, stats.runElements));
+    runBuffer.resize(capacity);
+    FilePtr input = openFile(inputPath, "rb");
+
+    bool singleRun = stats.elements <= stats.runElements;
+    if (singleRun) {
+        size_t count = readKeys(input.get(), runBuffer.data(), capacity, inputPath);
+        sortRun(std::span<Key>(runBuffer.data(), count));
+        FilePtr output = openFile(outputPath, "wb");
+        writeKeys(output.get(), runBuffer.data(), count, outputPath);
+        pass.bytesRead = pass.bytesWritten = count * sizeof(Key);
+        pass.outputRuns = 1;
+    } else {
+        while (true) {
+            size_t count = readKeys(input.get(), runBuffer.data(), capacity, inputPath);
+            if (count == 0) break;
+            sortRun(std::span<Key>(runBuffer.data(), count));
+
+            std::string path = tempPath(0, runs.size());
+            tempFiles.push_back(path);
+            FilePtr output = openFile(path, "wb");
+            writeKeys(output.get(), runBuffer.data(), count, path);
+            runs.push_back(path);
+
+            pass.bytesRead += count * sizeof(Key);
+            pass.bytesWritten += count * sizeof(Key);
+        }
+        pass.outputRuns = runs.size();
+    }
+
+    pass.timeTaken = elapsedMs(start);
+    stats.passes.push_back(pass);
+    return runs;
+}
+
+// 段内排序不插桩，int 键可使用 SIMD 排序网络等快速路径
+void ExternalSorter::sortRun(std::span<Key> run) {
+    scratchBuffer.resize(run.size());
+    dispatchSort<Key, std::less<Key>, NoInstrumentation>(options.runAlgorithm, run, scratchBuffer, options.pool);
+}
+
+// k 路归并：预算平分给 k 个输入缓冲区和 1 个输出缓冲区
+void ExternalSorter::mergeRuns(const std::vector<std::string>& runs, const std::string& outputPath, ExternalSortPass& pass) {
+    size_t bufferElements = std::max<size_t>(options.memoryBudget / (runs.size() + 1) / sizeof(Key), 1024);
+
+    std::vector<RunReader> readers;
+    readers.reserve(runs.size());
+    for (const auto& path : runs) readers.emplace_back(path, bufferElements);
+
+    RunWriter writer(outputPath, bufferElements);
+    LoserTree tree(readers);
+    while (!readers[tree.winner()].exhausted()) {
+        RunReader& reader = readers[tree.winner()];
+        writer.push(reader.current());
+        reader.advance();
+        tree.replay();
+    }
+    writer.finish();
+
+    for (const auto& reader : readers) pass.bytesRead += reader.getBytesRead();
+    pass.bytesWritten += writer.getBytesWritten();
+}
+
+std::string ExternalSorter::tempPath(int pass, size_t index) const {
+    // 以随机标记区分同时运行的多个排序（包括其他进程中的）
+    std::string name = "extsort_" + std::to_string(tempToken) + "_" + std::to_string(pass) + "_" +
+                       std::to_string(index) + ".run";
+    return (std::filesystem::path(options.tempDirectory) / name).string();
+}
+
+void ExternalSorter::writeRandomKeyFile(const std::string& path, uint64_t count, uint32_t seed) {
+    const size_t chunk = size_t(1) << 20;
+    std::vector<Key> buffer(static_cast<size_t>(std::min<uint64_t>(count, chunk)));
+    CounterRng rng(seed);
+    FilePtr file = openFile(path, "wb");
+
+    for (uint64_t written = 0; written < count;) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(count - written, chunk));
+        for (size_t i = 0; i < n; i++) buffer[i] = static_cast<Key>(rng(written + i));
+        writeKeys(file.get(), buffer.data(), n, path);
+        written += n;
+    }
+}
+
+bool ExternalSorter::isKeyFileSorted(const std::string& path) {
+    RunReader reader(path, size_t(1) << 20);
+    if (reader.exhausted()) return true;
+    Key previous = reader.current();
+    for (reader.advance(); !reader.exhausted(); reader.advance()) {
+        if (reader.current() < previous) return false;
+        previous = reader.current();
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sorting_engine.h"
+#include "thread_pool.h"
+
+// 外部排序：对超过内存的 int32 键文件（原始小端二进制，无文件头）排序
+//   第 0 遍：按内存预算分段读入，段内用 SortingEngine 排序后写入临时文件
+//   之后每遍：用败者树对至多 maxFanIn 个有序段做 k 路归并，直到只剩一个段
+// 每遍统计读写字节数，临时文件在归并后立即删除。I/O 失败时抛出 std::runtime_error，
+// 段内排序算法无法执行（并行算法未给线程池）时抛出 std::invalid_argument。
+
+struct ExternalSortOptions {
+    size_t memoryBudget = size_t(256) << 20;        // 段排序与归并缓冲区可用的总字节数
+    size_t maxFanIn = 64;                           // 单遍最多同时归并的段数
+    std::string tempDirectory;                      // 临时文件目录，空表示系统临时目录
+    SortAlgorithm runAlgorithm = SortAlgorithm::PdqSort; // 段内排序算法
+    ThreadPool* pool = nullptr;                     // 段内排序为并行算法时使用（不持有）
+};
+
+// 单遍统计
+struct ExternalSortPass {
+    int pass;              // 0 为生成有序段，之后为归并遍
+    size_t inputRuns;      // 本遍读取的段数（第 0 遍为 0）
+    size_t outputRuns;     // 本遍产生的段数
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    double timeTaken;      // 毫秒
+};
+
+struct ExternalSortStats {
+    uint64_t elements = 0;
+    size_t runElements = 0;  // 每个初始段的元素数
+    size_t fanIn = 0;        // 实际使用的归并路数
+    std::vector<ExternalSortPass> passes;
+
+    uint64_t totalBytesRead() const;
+    uint64_t totalBytesWritten() const;
+};
+
+class ExternalSorter {
+public:
+    using Key = int32_t;
+
+    // 归并时每个输入/输出缓冲区的最小字节数，路数会据此按内存预算收缩
+    static constexpr size_t kMinMergeBufferBytes = size_t(64) << 10;
+
+    explicit ExternalSorter(ExternalSortOptions options = ExternalSortOptions());
+
+    // 将 inputPath 中的键排序后写入 outputPath（两者不能相同）
+    void sortFile(const std::string& inputPath, const std::string& outputPath);
+
+    const ExternalSortStats& getStats() const { return stats; }
+
+    // 流式生成 count 个随机键（用于测试），内存占用与 count 无关
+    static void writeRandomKeyFile(const std::string& path, uint64_t count, uint32_t seed);
+    // 流式检查文件中的键是否升序
+    static bool isKeyFileSorted(const std::string& path);
+
+private:
+    ExternalSortOptions options;
+    ExternalSortStats stats;
+    std::vector<Key> runBuffer;
+    std::vector<Key> scratchBuffer;
+    // 临时段文件名中的随机标记，同一目录下不同进程、不同对象的文件互不冲突
+    uint64_t tempToken;
+    // 已创建、尚未删除的临时段文件；sortFile 无论正常结束还是因异常退出都会删除它们
+    std::vector<std::string> tempFiles;
+
+    std::vector<std::string> createRuns(const std::string& inputPath, const std::string& outputPath);
+    void mergeRuns(const std::vector<std::string>& runs, const std::string& outputPath, ExternalSortPass& pass);
+    void sortRun(std::span<Key> run);
+    std::string tempPath(int pass, size_t index) const;
+};
+
+#endif // EXTERNAL_SORT_H
@@ -0,0 +1,311 @@
+#include "frame_renderer.h"
+#include "replay_scheduler.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+struct FileCloser {
+    void operator()(std::FILE* file) const {
+        if (file) std::fclose(file);
+    }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    FilePtr file(std::fopen(path.c_str(), "wb"));
+    if (!file) throw std::runtime_error("无法创建图像文件: " + path);
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file.get()) == bytes.size();
+    if (ok) ok = std::fclose(file.release()) == 0;
+    if (!ok) throw std::runtime_error("写入图像文件失败: " + path);
+}
+
+void putBigEndian32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// PNG 块：长度、类型、数据、CRC（覆盖类型与数据）
+void putPngChunk(std::vector<uint8_t>& out, const char type[4], const std::vector<uint8_t>& payload) {
+    putBigEndian32(out, static_cast<uint32_t>(payload.size()));
+    size_t typeStart = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), payload.begin(), payload.end());
+    putBigEndian32(out, crc32(out.data() + typeStart, out.size() - typeStart));
+}
+
+// 把 [first, last) 内的元素聚合到一列
+struct ColumnExtent {
+    int minValue;
+    int maxValue;
+};
+
+ColumnExtent columnExtent(const int* first, const int* last) {
+    ColumnExtent extent{*first, *first};
+    for (const int* p = first + 1; p < last; p++) {
+        extent.minValue = std::min(extent.minValue, *p);
+        extent.maxValue = std::max(extent.maxValue, *p);
+    }
+    return extent;
+}
+
+} // namespace
+
+void Framebuffer::resize(int width, int height) {
+    w = std::max(0, width);
+    h = std::max(0, height);
+    pixels.resize(static_cast<size_t>(w) * h);
+}
+
+void Framebuffer::clear(Rgba color) {
+    std::fill(pixels.begin(), pixels.end(), color);
+}
+
+BarValueRange barValueRange(std::span<const int> values) {
+    BarValueRange range;
+    if (values.empty()) return range;
+    auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+    range.low = std::min(0, *minIt);
+    range.high = std::max(range.low + 1, *maxIt);
+    return range;
+}
+
+std::pair<int, int> barColumnsOf(size_t begin, size_t end, size_t count, int width) {
+    end = std::min(end, count);
+    if (begin >= end || width <= 0) return {0, 0};
+    const size_t w = static_cast<size_t>(width);
+    auto ceilDiv = [count](size_t a) { return (a + count - 1) / count; };
+    // 列 x 对应下标 [x·n/w, (x+1)·n/w)：n >= w 时下标 i 落在第 ceil((i+1)·w/n) - 1 列，
+    // n < w 时元素 i 占第 ceil(i·w/n) 到 ceil((i+1)·w/n) - 1 列
+    size_t first = count >= w ? ceilDiv((begin + 1) * w) - 1 : ceilDiv(begin * w);
+    size_t last = ceilDiv(end * w);
+    return {static_cast<int>(std::min(first, w)), static_cast<int>(std::min(last, w))};
+}
+
+void BarChartRenderer::render(Framebuffer& target, std::span<const int> values, BarValueRange range, int highlight1,
+                              int highlight2) {
+    renderColumns(target, values, range, 0, target.width(), highlight1, highlight2);
+    lastTarget = &target;
+    lastWidth = target.width();
+    lastHeight = target.height();
+    lastCount = values.size();
+    lastRange = range;
+    valid = true;
+}
+
+const DirtyRanges& BarChartRenderer::renderDirty(Framebuffer& target, std::span<const int> values,
+                                                 BarValueRange range, const DirtyRanges& dirty, int highlight1,
+                                                 int highlight2) {
+    columnDirty.clear();
+    if (!valid || lastTarget != &target || lastWidth != target.width() || lastHeight != target.height() ||
+        lastCount != values.size() || lastRange.low != range.low || lastRange.high != range.high) {
+        render(target, values, range, highlight1, highlight2);
+        columnDirty.mark(0, static_cast<size_t>(target.width()));
+        return columnDirty;
+    }
+
+    for (const DirtyRanges::Range& r : dirty.ranges()) {
+        auto [first, last] = barColumnsOf(r.begin, r.end, values.size(), target.width());
+        columnDirty.mark(static_cast<size_t>(first), static_cast<size_t>(last));
+    }
+    for (const DirtyRanges::Range& c : columnDirty.ranges()) {
+        renderColumns(target, values, range, static_cast<int>(c.begin), static_cast<int>(c.end), highlight1,
+                      highlight2);
+    }
+    return columnDirty;
+}
+
+void BarChartRenderer::renderColumns(Framebuffer& target, std::span<const int> values, BarValueRange range,
+                                     int firstColumn, int lastColumn, int highlight1, int highlight2) {
+    const int width = target.width();
+    const int height = target.height();
+    if (width == 0 || height == 0 || firstColumn >= lastColumn) return;
+
+    solidTop.resize(width);
+    spreadTop.resize(width);
+    solidColor.resize(width);
+    spreadColor.resize(width);
+
+    const size_t n = values.size();
+    const int64_t low = range.low;
+    const int64_t span = std::max<int64_t>(1, static_cast<int64_t>(range.high) - low);
+    // 行号 >= 顶端的像素被填充；值为 low 时顶端为 height，即不画
+    auto topOf = [&](int value) {
+        int64_t clamped = std::clamp<int64_t>(value, low, range.high);
+        return static_cast<int32_t>(height - (clamped - low) * height / span);
+    };
+    const bool gaps = n > 0 && n * 3 <= static_cast<size_t>(width);
+
+    for (int x = firstColumn; x < lastColumn; x++) {
+        size_t lo = static_cast<size_t>(x) * n / width;
+        size_t hi = static_cast<size_t>(x + 1) * n / width;
+        if (n == 0 || (gaps && hi > lo)) {
+            solidTop[x] = spreadTop[x] = height;
+            solidColor[x] = spreadColor[x] = style.background;
+            continue;
+        }
+        hi = std::max(hi, lo + 1);
+
+        ColumnExtent extent = columnExtent(values.data() + lo, values.data() + hi);
+        bool highlighted = (highlight1 >= 0 && static_cast<size_t>(highlight1) - lo < hi - lo) ||
+                           (highlight2 >= 0 && static_cast<size_t>(highlight2) - lo < hi - lo);
+        solidTop[x] = topOf(extent.minValue);
+        spreadTop[x] = topOf(extent.maxValue);
+        solidColor[x] = highlighted ? style.highlight : style.bar;
+        spreadColor[x] = highlighted ? style.highlight : style.spread;
+    }
+
+    const int32_t* solid = solidTop.data();
+    const int32_t* spread = spreadTop.data();
+    const Rgba* solidFill = solidColor.data();
+    const Rgba* spreadFill = spreadColor.data();
+    const Rgba background = style.background;
+    for (int y = 0; y < height; y++) {
+        Rgba* out = target.row(y);
+        for (int x = firstColumn; x < lastColumn; x++) {
+            // 比较结果扩展成全 0 / 全 1 掩码再按位选择：读取无条件，循环内没有分支
+            Rgba spreadMask = 0u - static_cast<Rgba>(y >= spread[x]);
+            Rgba solidMask = 0u - static_cast<Rgba>(y >= solid[x]);
+            Rgba color = (spreadFill[x] & spreadMask) | (background & ~spreadMask);
+            out[x] = (solidFill[x] & solidMask) | (color & ~solidMask);
+        }
+    }
+}
+
+void writePpm(const std::string& path, const Framebuffer& frame) {
+    char header[48];
+    int headerBytes = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", frame.width(), frame.height());
+    std::vector<uint8_t> bytes(header, header + headerBytes);
+    bytes.reserve(bytes.size() + static_cast<size_t>(frame.width()) * frame.height() * 3);
+    for (Rgba pixel : frame.data()) {
+        bytes.push_back(static_cast<uint8_t>(pixel));
+        bytes.push_back(static_cast<uint8_t>(pixel >> 8));
+        bytes.push_back(static_cast<uint8_t>(pixel >> 16));
+    }
+    writeFile(path, bytes);
+}
+
+void writePng(const std::string& path, const Framebuffer& frame) {
+    static constexpr uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    static constexpr size_t kStoredBlockBytes = 65535;
+
+    std::vector<uint8_t> bytes(kSignature, kSignature + 8);
+
+    std::vector<uint8_t> ihdr;
+    putBigEndian32(ihdr, static_cast<uint32_t>(frame.width()));
+    putBigEndian32(ihdr, static_cast<uint32_t>(frame.height()));
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0}); // 8 位 RGBA，deflate，无隔行
+    putPngChunk(bytes, "IHDR", ihdr);
+
+    // 扫描行 = 过滤类型 0 + RGBA 像素；像素内存布局即 R, G, B, A
+    const size_t rowBytes = static_cast<size_t>(frame.width()) * sizeof(Rgba);
+    std::vector<uint8_t> raw;
+    raw.reserve((rowBytes + 1) * frame.height());
+    for (int y = 0; y < frame.height(); y++) {
+        const Rgba* row = frame.row(y);
+        raw.push_back(0);
+        for (int x = 0; x < frame.width(); x++) {
+            raw.push_back(static_cast<uint8_t>(row[x]));
+            raw.push_back(static_cast<uint8_t>(row[x] >> 8));
+            raw.push_back(static_cast<uint8_t>(row[x] >> 16));
+            raw.push_back(static_cast<uint8_t>(row[x] >> 24));
+        }
+    }
+
+    // zlib 流：头部、若干存储块（每块最多 65535 字节）、Adler-32
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    idat.reserve(raw.size() + raw.size() / kStoredBlockBytes * 5 + 16);
+    size_t offset = 0;
+    do {
+        size_t length = std::min(kStoredBlockBytes, raw.size() - offset);
+        bool last = offset + length == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(static_cast<uint8_t>(length));
+        idat.push_back(static_cast<uint8_t>(length >> 8));
+        idat.push_back(static_cast<uint8_t>(~length));
+        idat.push_back(static_cast<uint8_t>(~length >> 8));
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size();) {
+        size_t end = std::min(raw.size(), i + 5552); // 5552 字节内累加不会溢出
+        for (; i < end; i++) {
+            a += raw[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    putBigEndian32(idat, (b << 16) | a);
+    putPngChunk(bytes, "IDAT", idat);
+    putPngChunk(bytes, "IEND", {});
+    writeFile(path, bytes);
+}
+
+FrameExportResult exportTraceFrames(const SortTrace& trace, const std::string& directory,
+                                    const FrameExportOptions& options) {
+    if (options.width <= 0 || options.height <= 0) throw std::runtime_error("图像尺寸必须大于 0");
+    std::filesystem::create_directories(directory);
+
+    FrameExportResult result;
+    Framebuffer frame(options.width, options.height);
+    BarChartRenderer renderer;
+    BarValueRange range = barValueRange(trace.initial);
+    TraceReplayer replayer(trace);
+    ReplayScheduler<ManualReplayClock> scheduler(options.framesPerSecond, options.speed);
+    scheduler.start();
+    const char* extension = options.format == FrameImageFormat::Png ? ".png" : ".ppm";
+
+    ReplayFrame replayFrame;
+    replayFrame.finished = replayer.done();
+    while (result.frames < std::max<size_t>(1, options.maxFrames)) {
+        auto start = std::chrono::steady_clock::now();
+        // 相邻两帧只重画调度器给出的脏下标所在的列（第一帧整帧绘制）
+        renderer.renderDirty(frame, replayer.values(), range, replayFrame.dirty, replayFrame.highlight1,
+                             replayFrame.highlight2);
+        auto rendered = std::chrono::steady_clock::now();
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "_%05zu", result.frames);
+        std::string path = (std::filesystem::path(directory) / (options.prefix + name + extension)).string();
+        if (options.format == FrameImageFormat::Png) writePng(path, frame);
+        else writePpm(path, frame);
+        auto written = std::chrono::steady_clock::now();
+
+        result.renderMs += std::chrono::duration<double, std::milli>(rendered - start).count();
+        result.writeMs += std::chrono::duration<double, std::milli>(written - rendered).count();
+        result.bytes += std::filesystem::file_size(path);
+        result.frames++;
+        if (replayFrame.finished) break;
+
+        scheduler.getClock().advance(scheduler.untilNextFrame());
+        scheduler.nextFrame(replayer, replayFrame);
+    }
+    result.events = replayer.position();
+    result.finished = replayer.done();
+    return result;
+}
@@ -0,0 +1,158 @@
+#ifndef FRAME_RENDERER_H
+#define FRAME_RENDERER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "replay_scheduler.h"
+#include "sort_trace.h"
+
+// 与平台无关的软件光栅化：把柱状图直接画进 RGBA 帧缓冲区，再导出为 PPM/PNG。
+// 不依赖 GDI 或任何图形库，可在无界面的 Linux 上批量生成排序过程的图像序列。
+// 出错时抛出 std::runtime_error。
+
+// 像素按字节 R, G, B, A 排列（小端下即 0xAABBGGRR）
+using Rgba = uint32_t;
+
+constexpr Rgba makeRgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+    return static_cast<Rgba>(r) | (static_cast<Rgba>(g) << 8) | (static_cast<Rgba>(b) << 16) |
+           (static_cast<Rgba>(a) << 24);
+}
+
+// 交换红蓝通道：GDI 的 32 位 DIB 按 B, G, R 排列
+constexpr Rgba swapRedBlue(Rgba color) {
+    return (color & 0xFF00FF00u) | ((color & 0xFFu) << 16) | ((color >> 16) & 0xFFu);
+}
+
+// 行优先、紧密排列的 RGBA 帧缓冲区
+class Framebuffer {
+public:
+    Framebuffer() = default;
+    Framebuffer(int width, int height) { resize(width, height); }
+
+    // 尺寸变化时内容未定义
+    void resize(int width, int height);
+    void clear(Rgba color);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    Rgba* row(int y) { return pixels.data() + static_cast<size_t>(y) * w; }
+    const Rgba* row(int y) const { return pixels.data() + static_cast<size_t>(y) * w; }
+    std::span<const Rgba> data() const { return pixels; }
+
+private:
+    int w = 0;
+    int h = 0;
+    std::vector<Rgba> pixels;
+};
+
+// 配色与 GUI 一致：黑底、蓝色柱、红色高亮
+struct BarChartStyle {
+    Rgba background = makeRgba(0, 0, 0);
+    Rgba bar = makeRgba(0, 200, 255);
+    Rgba spread = makeRgba(0, 90, 120);   // 一列聚合多个元素时，最小值与最大值之间的部分
+    Rgba highlight = makeRgba(255, 0, 0);
+};
+
+inline BarChartStyle swapRedBlue(const BarChartStyle& style) {
+    return {swapRedBlue(style.background), swapRedBlue(style.bar), swapRedBlue(style.spread),
+            swapRedBlue(style.highlight)};
+}
+
+// 下标区间 [begin, end) 在宽度为 width 的画布上覆盖的像素列区间 [first, second)
+std::pair<int, int> barColumnsOf(size_t begin, size_t end, size_t count, int width);
+
+// 柱高的取值范围（按初始数据确定，回放过程中不变，柱子不会随帧缩放）
+struct BarValueRange {
+    int low = 0;
+    int high = 1;
+};
+
+// 包含 0 的取值范围，负数柱从底部画起
+BarValueRange barValueRange(std::span<const int> values);
+
+// 柱状图光栅化。每个像素列对应一段下标 [x·n/width, (x+1)·n/width)：
+// n 不超过宽度时一个元素占若干列（每个元素最后一列留作间隔，元素至少占 3 列时），
+// n 超过宽度时一列聚合多个元素，按最小值画实心部分、最大值画浅色部分，
+// 排好序的区段因此是一条细线，乱序的区段是一片浅色带。
+// 先逐列算出顶端与颜色，再逐行按“行号 >= 顶端”选择颜色写入，内层循环无分支、可向量化。
+// renderDirty() 只重画脏下标所在的列；画布、尺寸、元素个数或取值范围与上次不同时整帧重画
+class BarChartRenderer {
+public:
+    static constexpr size_t kMaxDirtyColumnRanges = 64;
+
+    explicit BarChartRenderer(const BarChartStyle& style = BarChartStyle()) : style(style) {}
+
+    // 整帧重画
+    void render(Framebuffer& target, std::span<const int> values, BarValueRange range, int highlight1 = -1,
+                int highlight2 = -1);
+
+    // 只重画 dirty 中下标覆盖的列（dirty 须包含自上次绘制以来变化过的值与高亮），
+    // 返回实际重画的像素列区间，前端只需刷新这些区域
+    const DirtyRanges& renderDirty(Framebuffer& target, std::span<const int> values, BarValueRange range,
+                                   const DirtyRanges& dirty, int highlight1 = -1, int highlight2 = -1);
+
+    // 下一次 renderDirty() 整帧重画（数据被整体替换等）
+    void invalidate() { valid = false; }
+
+    void setStyle(const BarChartStyle& newStyle) {
+        style = newStyle;
+        invalidate();
+    }
+    const BarChartStyle& getStyle() const { return style; }
+
+private:
+    BarChartStyle style;
+    DirtyRanges columnDirty{kMaxDirtyColumnRanges};
+    // 上一次整帧绘制的画布与参数，任一不同即需要整帧重画
+    const Framebuffer* lastTarget = nullptr;
+    int lastWidth = 0;
+    int lastHeight = 0;
+    size_t lastCount = 0;
+    BarValueRange lastRange;
+    bool valid = false;
+    // 每列的实心顶端、浅色顶端及对应颜色（复用，避免每帧分配）
+    std::vector<int32_t> solidTop;
+    std::vector<int32_t> spreadTop;
+    std::vector<Rgba> solidColor;
+    std::vector<Rgba> spreadColor;
+
+    void renderColumns(Framebuffer& target, std::span<const int> values, BarValueRange range, int firstColumn,
+                       int lastColumn, int highlight1, int highlight2);
+};
+
+// 二进制 PPM（P6，RGB）
+void writePpm(const std::string& path, const Framebuffer& frame);
+// PNG（RGBA 8 位，deflate 仅用不压缩的存储块，不依赖 zlib）
+void writePng(const std::string& path, const Framebuffer& frame);
+
+enum class FrameImageFormat { Ppm, Png };
+
+struct FrameExportOptions {
+    int width = 640;
+    int height = 360;
+    double framesPerSecond = 30.0;
+    double speed = 1.0;             // 同 ReplayScheduler：1 为每秒 1000 个事件
+    size_t maxFrames = 1000;        // 超过时提前结束（最后一帧仍为当时的状态）
+    FrameImageFormat format = FrameImageFormat::Ppm;
+    std::string prefix = "frame";   // 文件名为 prefix_00000.ppm
+};
+
+struct FrameExportResult {
+    size_t frames = 0;
+    size_t events = 0;      // 已回放的事件数
+    bool finished = false;  // 是否回放到了最后
+    uint64_t bytes = 0;
+    double renderMs = 0.0;  // 只含光栅化
+    double writeMs = 0.0;   // 编码与写文件
+};
+
+// 按 ReplayScheduler 的帧划分回放 trace（手动时钟），每帧渲染并写入 directory；
+// 第一帧为初始状态，最后一帧为结束状态
+FrameExportResult exportTraceFrames(const SortTrace& trace, const std::string& directory,
+                                    const FrameExportOptions& options = FrameExportOptions());
+
+#endif // FRAME_RENDERER_H
@@ -1,14 +1,31 @@
 #include <iostream>
 #include <vector>
 #include <iomanip>
-#include <io.h>
-#include <fcntl.h>
+#include <thread>
+#include <optional>
+#include <random>
 #include "sorting_system.h"
+#include "external_sort.h"
+#include "benchmark.h"
+#include "cli.h"
+#include "sort_benchmarks.h"
+#include "replay_experiments.h"
+#include <fstream>
+#include <sstream>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#endif
 
 void setShowChinese() {
-    // 设置控制台输出编码为UTF-8
-    system("chcp 65001 > nul");
+#ifdef _WIN32
+    // 设置控制台输入输出编码为UTF-8（其他平台的终端默认即为 UTF-8）
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+#endif
 }
 
 void showMenu() {
@@ -21,6 +38,23 @@ void showMenu() {
     std::cout << "6. 显示当前数据" << std::endl;
     std::cout << "7. 运行性能比较" << std::endl;
     std::cout << "8. 动画演示排序过程" << std::endl;
+    std::cout << "9. 插桩开销基准测试" << std::endl;
+    std::cout << "10. 并行加速比测试" << std::endl;
+    std::cout << "11. 设置并行线程数" << std::endl;
+    std::cout << "12. 排序网络基准测试" << std::endl;
+    std::cout << "13. 外部排序（二进制键文件）" << std::endl;
+    std::cout << "14. 载入数据集文件" << std::endl;
+    std::cout << "15. 保存当前数据为数据集文件" << std::endl;
+    std::cout << "16. 内存映射排序数据集文件" << std::endl;
+    std::cout << "17. 统计基准测试矩阵（JSON/CSV 输出）" << std::endl;
+    std::cout << "18. 生成其他分布数据（Zipf、锯齿、k-有序等）" << std::endl;
+    std::cout << "19. 堆排序分叉数基准测试" << std::endl;
+    std::cout << "20. 记录排序事件并回放" << std::endl;
+    std::cout << "21. 录制排序追踪文件并按步定位" << std::endl;
+    std::cout << "22. 按帧合并回放模拟（无界面）" << std::endl;
+    std::cout << "23. 导出排序过程图像序列（PPM/PNG）" << std::endl;
+    std::cout << "24. 增量重绘基准测试（每帧整帧重画 vs 只重画脏列）" << std::endl;
+    std::cout << "25. 设置数据生成种子" << std::endl;
     std::cout << "0. 退出程序" << std::endl;
     std::cout << "========================================" << std::endl;
     std::cout << "请选择操作: ";
@@ -34,6 +68,13 @@ void showSortingAlgorithms() {
     std::cout << "4. 堆排序" << std::endl;
     std::cout << "5. 插入排序" << std::endl;
     std::cout << "6. 选择排序" << std::endl;
+    std::cout << "7. 内省排序" << std::endl;
+    std::cout << "8. 模式消除快速排序" << std::endl;
+    std::cout << "9. 并行归并排序" << std::endl;
+    std::cout << "10. 并行快速排序" << std::endl;
+    std::cout << "11. LSD 基数排序" << std::endl;
+    std::cout << "12. MSD 基数排序" << std::endl;
+    std::cout << "13. 自然归并排序（powersort）" << std::endl;
     std::cout << "==========================" << std::endl;
     std::cout << "请选择算法: ";
 }
@@ -67,6 +108,34 @@ void demonstrateSorting(SortingSystem& system, int choice) {
             std::cout << "\n选择排序过程演示:" << std::endl;
             system.selectionSort();
             break;
+        case 7:
+            std::cout << "\n内省排序过程演示:" << std::endl;
+            system.introSort();
+            break;
+        case 8:
+            std::cout << "\n模式消除快速排序过程演示:" << std::endl;
+            system.pdqSort();
+            break;
+        case 9:
+            std::cout << "\n并行归并排序过程演示:" << std::endl;
+            system.parallelMergeSort();
+            break;
+        case 10:
+            std::cout << "\n并行快速排序过程演示:" << std::endl;
+            system.parallelQuickSort();
+            break;
+        case 11:
+            std::cout << "\nLSD 基数排序过程演示:" << std::endl;
+            system.radixSortLSD();
+            break;
+        case 12:
+            std::cout << "\nMSD 基数排序过程演示:" << std::endl;
+            system.radixSortMSD();
+            break;
+        case 13:
+            std::cout << "\n自然归并排序过程演示:" << std::endl;
+            system.powerSort();
+            break;
     }
     
     std::cout << "\n排序后数据:" << std::endl;
@@ -74,78 +143,322 @@ void demonstrateSorting(SortingSystem& system, int choice) {
     std::cout << "排序结果验证: " << (system.isSorted() ? "正确" : "错误") << std::endl;
 }
 
+// 单个硬件计数值，不可用时显示 "-"
+std::string formatHardwareCounter(const HardwareCounters& counters, HardwareCounter counter) {
+    return counters.has(counter) ? std::to_string(counters.get(counter)) : "-";
+}
+
+void printHardwareCounters(SortingSystem& system, const std::vector<SortPerformance>& results) {
+    const PerfCounterGroup& perfCounters = system.getPerfCounters();
+    if (!perfCounters.available()) {
+        std::cout << "\n硬件计数器不可用：" << perfCounters.unavailableReason() << std::endl;
+        return;
+    }
+
+    std::cout << "\n硬件计数器（每次排序平均，含计数插桩开销；并行算法只统计调用线程）" << std::endl;
+    std::cout << std::left << std::setw(22) << "算法名称"
+              << std::setw(14) << "cycles"
+              << std::setw(14) << "instructions"
+              << std::setw(7) << "IPC"
+              << std::setw(14) << "branch-miss"
+              << std::setw(12) << "L1d-miss"
+              << std::setw(12) << "LLC-miss"
+              << std::setw(12) << "dTLB-miss" << std::endl;
+    std::cout << std::string(107, '-') << std::endl;
+    for (const SortPerformance& perf : results) {
+        const HardwareCounters& hw = perf.hardware;
+        std::cout << std::left << std::setw(22) << perf.algorithmName
+                  << std::setw(14) << formatHardwareCounter(hw, HardwareCounter::Cycles)
+                  << std::setw(14) << formatHardwareCounter(hw, HardwareCounter::Instructions)
+                  << std::setw(7) << std::fixed << std::setprecision(2) << hw.ipc()
+                  << std::setw(14) << formatHardwareCounter(hw, HardwareCounter::BranchMisses)
+                  << std::setw(12) << formatHardwareCounter(hw, HardwareCounter::L1DMisses)
+                  << std::setw(12) << formatHardwareCounter(hw, HardwareCounter::LLCMisses)
+                  << std::setw(12) << formatHardwareCounter(hw, HardwareCounter::DTLBMisses) << std::endl;
+    }
+}
+
 void runPerformanceTest(SortingSystem& system) {
     std::cout << "\n======= 性能比较测试 =======\n" << std::endl;
-    std::cout << std::left << std::setw(15) << "算法名称" 
-              << std::setw(12) << "耗时(ms)" 
-              << std::setw(15) << "比较次数" 
-              << std::setw(10) << "交换次数" 
+    std::cout << std::left << std::setw(22) << "算法名称" 
+              << std::setw(14) << "中位耗时(ms)" 
+              << std::setw(12) << "标准差(ms)" 
+              << std::setw(15) << "比较次数/遍数" 
+              << std::setw(14) << "交换/搬移字节" 
+              << std::setw(10) << "内存分配"
               << std::setw(8) << "稳定性" << std::endl;
-    std::cout << std::string(60, '-') << std::endl;
-
-    // 测试各种排序算法
-    std::vector<std::pair<std::string, void (SortingSystem::*)()>> algorithms = {
-        {"Bubble Sort", &SortingSystem::bubbleSort},
-        {"Insertion Sort", &SortingSystem::insertionSort},
-        {"Selection Sort", &SortingSystem::selectionSort},
-        {"Quick Sort", &SortingSystem::quickSort},
-        {"Merge Sort", &SortingSystem::mergeSort},
-        {"Heap Sort", &SortingSystem::heapSort}
-    };
-
-    for (const auto& alg : algorithms) {
-        SortPerformance perf = system.testAlgorithm(alg.first, alg.second);
-        std::cout << std::left << std::setw(15) << perf.algorithmName
-                  << std::setw(12) << std::fixed << std::setprecision(3) << perf.timeTaken
-                  << std::setw(15) << perf.comparisons
-                  << std::setw(10) << perf.swaps
+    std::cout << std::string(95, '-') << std::endl;
+
+    // 测试所有已注册的排序算法；基数排序不做比较，改为显示分配遍数与搬移字节数
+    std::vector<SortPerformance> results;
+    for (SortAlgorithm algorithm : kAllSortAlgorithms) {
+        SortPerformance perf = system.testAlgorithm(sortAlgorithmName(algorithm), algorithm);
+        results.push_back(perf);
+        bool radix = (algorithm == SortAlgorithm::RadixSortLSD || algorithm == SortAlgorithm::RadixSortMSD);
+        std::cout << std::left << std::setw(22) << perf.algorithmName
+                  << std::setw(14) << std::fixed << std::setprecision(3) << perf.timeTaken
+                  << std::setw(12) << perf.timeStddev
+                  << std::setw(15) << (radix ? std::to_string(perf.passes) + " 遍" : std::to_string(perf.comparisons))
+                  << std::setw(14) << (radix ? std::to_string(perf.bytesMoved) + " B" : std::to_string(perf.swaps))
+                  << std::setw(10) << perf.allocations
                   << std::setw(8) << (perf.stable ? "稳定" : "不稳定") << std::endl;
     }
+
+    // 选择算法：取最小的 100 个 / 中位数，与完整排序对照
+    size_t n = system.getOriginalData().size();
+    size_t k = std::min<size_t>(100, n);
+    std::cout << "\n选择算法（只求最小的 " << k << " 个元素或中位数）" << std::endl;
+    std::cout << std::string(95, '-') << std::endl;
+    for (SelectionAlgorithm algorithm : kAllSelectionAlgorithms) {
+        bool median = algorithm == SelectionAlgorithm::NthElement;
+        std::string name = std::string(selectionAlgorithmName(algorithm)) + (median ? " (n/2)" : " (k=" + std::to_string(k) + ")");
+        SortPerformance perf = system.testSelection(name, algorithm, median ? n / 2 : k);
+        results.push_back(perf);
+        std::cout << std::left << std::setw(22) << perf.algorithmName
+                  << std::setw(14) << std::fixed << std::setprecision(3) << perf.timeTaken
+                  << std::setw(12) << perf.timeStddev
+                  << std::setw(15) << perf.comparisons
+                  << std::setw(14) << perf.swaps
+                  << std::setw(10) << perf.allocations
+                  << std::setw(8) << "-" << std::endl;
+    }
+
+    printHardwareCounters(system, results);
 }
 
-LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
-    static HWND hButton;
-    static HBRUSH hBrush; // 定义一个画刷用于设置背景色
+// 列出可记录事件的算法（并行算法的事件顺序不确定，不参与记录）并读取选择，无效时返回空
+std::optional<SortAlgorithm> chooseSortAlgorithm() {
+    std::vector<SortAlgorithm> algorithms;
+    for (SortAlgorithm algorithm : kAllSortAlgorithms) {
+        if (!isParallelSortAlgorithm(algorithm)) algorithms.push_back(algorithm);
+    }
+    std::cout << "\n可用排序算法:" << std::endl;
+    for (size_t i = 0; i < algorithms.size(); i++) {
+        std::cout << i + 1 << ". " << sortAlgorithmName(algorithms[i]) << std::endl;
+    }
+    std::cout << "请选择算法: ";
+    size_t choice;
+    std::cin >> choice;
+    if (choice < 1 || choice > algorithms.size()) {
+        std::cout << "无效的选择！" << std::endl;
+        return std::nullopt;
+    }
+    return algorithms[choice - 1];
+}
 
-    switch (message) {
-    case WM_CREATE:
-        hButton = CreateWindow(
-            TEXT("BUTTON"), TEXT("Click Me"),
-            WS_VISIBLE | WS_CHILD,
-            50, 50, 100, 30,
-            hWnd, (HMENU)1, NULL, NULL
-        );
-        hBrush = CreateSolidBrush(RGB(240, 240, 240)); // 创建浅灰色画刷
-        break;
+// 排序时把事件流式写入压缩追踪文件，之后按步数前后定位，不必重新排序
+void runTraceFile(const SortingSystem& system) {
+    std::string path;
+    std::cout << "请输入追踪文件路径: ";
+    std::cin >> path;
+    std::optional<SortAlgorithm> algorithm = chooseSortAlgorithm();
+    if (!algorithm) return;
+    runTraceFileRecording(std::cout, *algorithm, system.getData(), path);
 
-    case WM_CTLCOLORBTN: // 处理按钮的背景色
-    {
-        HDC hdcButton = (HDC)wParam;
-        SetTextColor(hdcButton, RGB(0, 0, 0)); // 设置按钮文字颜色为黑色
-        SetBkMode(hdcButton, TRANSPARENT); // 设置背景模式为透明
-        return (LRESULT)hBrush; // 返回背景画刷
+    TraceFileReader reader(path);
+    while (true) {
+        std::cout << "\n输入要定位的步数（0-" << reader.size() << "，-1 结束）: ";
+        long long target;
+        if (!(std::cin >> target) || target < 0) break;
+        showTraceFileStep(std::cout, reader, static_cast<uint64_t>(target));
     }
+}
 
-    case WM_COMMAND:
-        if (LOWORD(wParam) == 1) {
-            MessageBox(hWnd, TEXT("Button Clicked"), TEXT("Info"), MB_OK);
-        }
-        break;
+void runReplaySimulation(const SortingSystem& system) {
+    std::optional<SortAlgorithm> algorithm = chooseSortAlgorithm();
+    if (!algorithm) return;
+    double framesPerSecond, speed;
+    std::cout << "请输入目标帧率: ";
+    std::cin >> framesPerSecond;
+    std::cout << "请输入速度倍数（1 = 每秒 1000 个事件）: ";
+    std::cin >> speed;
+    runReplaySimulation(std::cout, *algorithm, system.getData(), framesPerSecond, speed);
+}
+
+void runFrameExport(const SortingSystem& system) {
+    std::optional<SortAlgorithm> algorithm = chooseSortAlgorithm();
+    if (!algorithm) return;
 
-    case WM_DESTROY:
-        DeleteObject(hBrush); // 销毁画刷
-        PostQuitMessage(0);
-        break;
+    FrameExportOptions options;
+    std::string directory;
+    int format;
+    std::cout << "请输入输出目录: ";
+    std::cin >> directory;
+    std::cout << "请输入图像宽度和高度（如 640 360）: ";
+    std::cin >> options.width >> options.height;
+    std::cout << "请输入帧率和速度倍数（如 30 1）: ";
+    std::cin >> options.framesPerSecond >> options.speed;
+    std::cout << "请输入最多导出的帧数: ";
+    std::cin >> options.maxFrames;
+    std::cout << "图像格式（1. PPM  2. PNG）: ";
+    std::cin >> format;
+    options.format = format == 2 ? FrameImageFormat::Png : FrameImageFormat::Ppm;
+    runFrameExport(std::cout, *algorithm, system.getData(), directory, options);
+}
+
+void runIncrementalRenderBenchmark() {
+    std::optional<SortAlgorithm> algorithm = chooseSortAlgorithm();
+    if (!algorithm) return;
+    double speed;
+    std::cout << "请输入速度倍数（1 = 每秒 1000 个事件）: ";
+    std::cin >> speed;
+    runIncrementalRenderBenchmark(std::cout, *algorithm, speed, {1000, 10000, 100000, 1000000});
+}
 
-    default:
-        return DefWindowProc(hWnd, message, wParam, lParam);
+void runExternalSort() {
+    std::string inputPath;
+    std::cout << "请输入待排序的 int32 键文件路径（输入 - 生成随机测试文件）: ";
+    std::cin >> inputPath;
+    if (inputPath == "-") {
+        uint64_t count;
+        std::cout << "请输入键的个数: ";
+        std::cin >> count;
+        inputPath = "external_sort_input.bin";
+        ExternalSorter::writeRandomKeyFile(inputPath, count, std::random_device{}());
+        std::cout << "已生成 " << inputPath << "（" << count * sizeof(int32_t) / (1 << 20) << " MB）。" << std::endl;
+    }
+
+    std::string outputPath;
+    std::cout << "请输入输出文件路径: ";
+    std::cin >> outputPath;
+
+    size_t budgetMb;
+    std::cout << "请输入内存预算（MB）: ";
+    std::cin >> budgetMb;
+    runExternalSort(std::cout, inputPath, outputPath, budgetMb);
+}
+
+void runMappedDatasetSort() {
+    std::string path;
+    std::cout << "请输入数据集文件路径: ";
+    std::cin >> path;
+
+    std::cout << "\n可用排序算法:" << std::endl;
+    for (size_t i = 0; i < kAllSortAlgorithms.size(); i++) {
+        std::cout << i + 1 << ". " << sortAlgorithmName(kAllSortAlgorithms[i]) << std::endl;
+    }
+    std::cout << "请选择算法: ";
+    size_t choice;
+    std::cin >> choice;
+    if (choice < 1 || choice > kAllSortAlgorithms.size()) {
+        std::cout << "无效的选择！" << std::endl;
+        return;
+    }
+
+    std::string outputPath;
+    std::cout << "请输入排序结果的保存路径（输入 - 不保存）: ";
+    std::cin >> outputPath;
+    runMappedDatasetSort(std::cout, path, kAllSortAlgorithms[choice - 1], outputPath == "-" ? "" : outputPath);
+}
+
+// 生成 Random/Ascending/Descending/PartiallySorted 以外的分布（参数取默认值，命令行模式下可调整）
+void generateOtherPattern(SortingSystem& system) {
+    std::cout << "\n======= 数据分布 =======" << std::endl;
+    for (size_t i = 4; i < kAllDataPatterns.size(); i++) {
+        std::cout << i - 3 << ". " << dataPatternName(kAllDataPatterns[i]) << std::endl;
+    }
+    std::cout << "========================" << std::endl;
+    std::cout << "请选择数据分布: ";
+    size_t choice;
+    std::cin >> choice;
+    if (choice < 1 || choice + 3 >= kAllDataPatterns.size()) {
+        std::cout << "无效的选择！" << std::endl;
+        return;
+    }
+
+    DataPattern pattern = kAllDataPatterns[choice + 3];
+    std::cout << "请输入数据量大小: ";
+    size_t dataSize;
+    std::cin >> dataSize;
+    system.generateData(dataSize, pattern);
+    std::cout << "已生成包含 " << dataSize << " 个元素的 " << dataPatternName(pattern) << " 数据集（种子 "
+              << system.getDataSeed() << "）。" << std::endl;
+}
+
+// 固定种子后，菜单生成的数据可以复现（与命令行模式的 --seed 相同）
+void chooseDataSeed(SortingSystem& system) {
+    if (system.getFixedSeed()) {
+        std::cout << "当前种子已固定为 " << *system.getFixedSeed() << "。" << std::endl;
+    } else {
+        std::cout << "当前每次生成都使用新的随机种子（生成后显示所用的种子）。" << std::endl;
+    }
+    std::string text;
+    std::cout << "请输入种子（输入 - 恢复为每次随机）: ";
+    std::cin >> text;
+    if (text == "-") {
+        system.setSeed(std::nullopt);
+        std::cout << "已恢复为每次随机。" << std::endl;
+        return;
+    }
+    try {
+        size_t parsed = 0;
+        uint64_t seed = std::stoull(text, &parsed);
+        if (parsed != text.size()) throw std::invalid_argument(text);
+        system.setSeed(seed);
+        std::cout << "种子已固定为 " << seed << "。" << std::endl;
+    } catch (const std::exception&) {
+        std::cout << "无效的种子！" << std::endl;
     }
-    return 0;
 }
 
-int main() {
+// algorithm × pattern × size 矩阵：预热 + 多次计时，输出中位数/p95/标准差/置信区间，可导出 JSON/CSV
+void runBenchmarkMatrix() {
+    BenchmarkConfig config;
+
+    std::string line;
+    std::cout << "请输入数据规模（逗号分隔，如 1000,10000,100000）: ";
+    std::cin >> line;
+    config.sizes.clear();
+    std::stringstream sizes(line);
+    for (std::string item; std::getline(sizes, item, ',');) {
+        if (!item.empty()) config.sizes.push_back(std::stoull(item));
+    }
+    std::cout << "请输入预热次数和计时次数: ";
+    std::cin >> config.warmupRuns >> config.trials;
+    config.trials = std::max(config.trials, 1);
+    config.warmupRuns = std::max(config.warmupRuns, 0);
+
+    std::string format;
+    std::cout << "请输入输出格式（json / csv / none）: ";
+    std::cin >> format;
+    std::string outputPath;
+    if (format == "json" || format == "csv") {
+        std::cout << "请输入输出文件路径: ";
+        std::cin >> outputPath;
+    }
+
+    BenchmarkRunner runner(config);
+    std::cout << "\n======= 统计基准测试（预热 " << config.warmupRuns << " 次，计时 " << config.trials
+              << " 次；O(n²) 情形超过 " << config.quadraticSizeLimit << " 个元素时跳过）=======\n" << std::endl;
+    BenchmarkRunner::writeTableHeader(std::cout);
+    if (!runner.hardwareCounters().available()) {
+        std::cout << "（硬件计数器不可用：" << runner.hardwareCounters().unavailableReason() << "）" << std::endl;
+    }
+
+    std::vector<BenchmarkResult> results = runner.run([](const BenchmarkResult& r) {
+        BenchmarkRunner::writeTableRow(std::cout, r);
+    });
+
+    if (!outputPath.empty()) {
+        std::ofstream out(outputPath);
+        if (!out) {
+            std::cout << "无法写入 " << outputPath << std::endl;
+            return;
+        }
+        if (format == "json") runner.writeJson(out, results);
+        else runner.writeCsv(out, results);
+        std::cout << "结果已写入 " << outputPath << "。" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
     // 设置控制台支持中文显示
     setShowChinese();
+
+    // 带参数时以无交互的命令行模式运行（见 cli.h），否则进入菜单
+    if (argc > 1) {
+        return runCli(argc, argv);
+    }
     
     SortingSystem system;
     int choice;
@@ -162,28 +475,32 @@ int main() {
                 std::cout << "请输入数据量大小: ";
                 std::cin >> dataSize;
                 system.generateData(dataSize, DataPattern::Random);
-                std::cout << "已生成包含 " << dataSize << " 个元素的随机数据集。" << std::endl;
+                std::cout << "已生成包含 " << dataSize << " 个元素的随机数据集（种子 " << system.getDataSeed()
+                          << "）。" << std::endl;
                 break;
 
             case 2: // 生成有序数据
                 std::cout << "请输入数据量大小: ";
                 std::cin >> dataSize;
                 system.generateData(dataSize, DataPattern::Ascending);
-                std::cout << "已生成包含 " << dataSize << " 个元素的有序数据集。" << std::endl;
+                std::cout << "已生成包含 " << dataSize << " 个元素的有序数据集（种子 " << system.getDataSeed()
+                          << "）。" << std::endl;
                 break;
 
             case 3: // 生成逆序数据
                 std::cout << "请输入数据量大小: ";
                 std::cin >> dataSize;
                 system.generateData(dataSize, DataPattern::Descending);
-                std::cout << "已生成包含 " << dataSize << " 个元素的逆序数据集。" << std::endl;
+                std::cout << "已生成包含 " << dataSize << " 个元素的逆序数据集（种子 " << system.getDataSeed()
+                          << "）。" << std::endl;
                 break;
 
             case 4: // 生成部分有序数据
                 std::cout << "请输入数据量大小: ";
                 std::cin >> dataSize;
                 system.generateData(dataSize, DataPattern::PartiallySorted);
-                std::cout << "已生成包含 " << dataSize << " 个元素的部分有序数据集。" << std::endl;
+                std::cout << "已生成包含 " << dataSize << " 个元素的部分有序数据集（种子 " << system.getDataSeed()
+                          << "）。" << std::endl;
                 break;
 
             case 5: // 手动输入数据
@@ -222,13 +539,155 @@ int main() {
                 showSortingAlgorithms();
                 int algChoice;
                 std::cin >> algChoice;
-                if (algChoice >= 1 && algChoice <= 6) {
+                if (algChoice >= 1 && algChoice <= 13) {
                     demonstrateSorting(system, algChoice);
                 } else {
                     std::cout << "无效的选择！" << std::endl;
                 }
                 break;
 
+            case 9: // 插桩开销基准测试
+                runInstrumentationBenchmark(std::cout, {100000, 1000000});
+                break;
+
+            case 10: // 并行加速比测试
+                std::cout << "请输入数据量大小: ";
+                std::cin >> dataSize;
+                runParallelSpeedupBenchmark(std::cout, dataSize);
+                break;
+
+            case 11: // 设置并行线程数
+            {
+                std::cout << "请输入线程数（0 表示使用全部硬件线程）: ";
+                size_t threads;
+                std::cin >> threads;
+                system.setThreadCount(threads);
+                std::cout << "并行线程数已设置为 " << (threads == 0 ? std::thread::hardware_concurrency() : threads) << "。" << std::endl;
+                break;
+            }
+
+            case 12: // 排序网络基准测试
+                runSortingNetworkBenchmark(std::cout);
+                break;
+
+            case 13: // 外部排序
+                try {
+                    runExternalSort();
+                } catch (const std::exception& e) {
+                    std::cout << "外部排序失败: " << e.what() << std::endl;
+                }
+                break;
+
+            case 14: // 载入数据集文件
+            {
+                std::string path;
+                std::cout << "请输入数据集文件路径: ";
+                std::cin >> path;
+                try {
+                    system.loadDataset(path);
+                    std::cout << "已载入 " << system.getData().size() << " 个元素。" << std::endl;
+                } catch (const std::exception& e) {
+                    std::cout << "载入失败: " << e.what() << std::endl;
+                }
+                break;
+            }
+
+            case 15: // 保存当前数据为数据集文件
+            {
+                std::string path;
+                std::cout << "请输入保存路径: ";
+                std::cin >> path;
+                try {
+                    system.saveDataset(path);
+                    std::cout << "已保存 " << system.getData().size() << " 个元素到 " << path << "。" << std::endl;
+                } catch (const std::exception& e) {
+                    std::cout << "保存失败: " << e.what() << std::endl;
+                }
+                break;
+            }
+
+            case 16: // 内存映射排序数据集文件
+                try {
+                    runMappedDatasetSort();
+                } catch (const std::exception& e) {
+                    std::cout << "排序失败: " << e.what() << std::endl;
+                }
+                break;
+
+            case 17: // 统计基准测试矩阵
+                try {
+                    runBenchmarkMatrix();
+                } catch (const std::exception& e) {
+                    std::cout << "基准测试失败: " << e.what() << std::endl;
+                }
+                break;
+
+            case 18: // 生成其他分布数据
+                generateOtherPattern(system);
+                break;
+
+            case 19: // 堆排序分叉数基准测试
+                runHeapArityBenchmark(std::cout, {100000, 1000000, 10000000});
+                break;
+
+            case 20: // 记录排序事件并回放
+                if (system.getData().empty()) {
+                    std::cout << "请先生成或输入数据！" << std::endl;
+                    break;
+                }
+                if (std::optional<SortAlgorithm> algorithm = chooseSortAlgorithm()) {
+                    runTraceRecording(std::cout, *algorithm, system.getData());
+                }
+                break;
+
+            case 21: // 录制排序追踪文件并按步定位
+                if (system.getData().empty()) {
+                    std::cout << "请先生成或输入数据！" << std::endl;
+                    break;
+                }
+                try {
+                    runTraceFile(system);
+                } catch (const std::exception& e) {
+                    std::cout << "追踪文件操作失败: " << e.what() << std::endl;
+                }
+                break;
+
+            case 22: // 按帧合并回放模拟
+                if (system.getData().empty()) {
+                    std::cout << "请先生成或输入数据！" << std::endl;
+                    break;
+                }
+                try {
+                    runReplaySimulation(system);
+                } catch (const std::exception& e) {
+                    std::cout << "回放模拟失败: " << e.what() << std::endl;
+                }
+                break;
+
+            case 23: // 导出排序过程图像序列
+                if (system.getData().empty()) {
+                    std::cout << "请先生成或输入数据！" << std::endl;
+                    break;
+                }
+                try {
+                    runFrameExport(system);
+                } catch (const std::exception& e) {
+                    std::cout << "导出失败: " << e.what() << std::endl;
+                }
+                break;
+
+            case 24: // 增量重绘基准测试
+                try {
+                    runIncrementalRenderBenchmark();
+                } catch (const std::exception& e) {
+                    std::cout << "基准测试失败: " << e.what() << std::endl;
+                }
+                break;
+
+            case 25: // 设置数据生成种子
+                chooseDataSeed(system);
+                break;
+
             case 0: // 退出程序
                 std::cout << "感谢使用排序算法性能比较与动画演示系统！" << std::endl;
                 return 0;
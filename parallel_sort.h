@@ -0,0 +1,267 @@
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "sorting_engine.h"
+#include "thread_pool.h"
+
+// 基于工作窃取线程池的并行排序
+// 小于 kSequentialThreshold 的子区间交给 SortingEngine 顺序排序，
+// 各子任务的比较/交换次数在任务结束时汇总（仅在插桩策略启用时）。
+template <typename T, typename Compare = std::less<T>, typename Instrumentation = CountingInstrumentation>
+class ParallelSorter {
+public:
+    using Engine = SortingEngine<T, Compare, Instrumentation>;
+
+    static constexpr size_t kSequentialThreshold = 1 << 14;
+
+    explicit ParallelSorter(ThreadPool& pool, Compare comp = Compare()) : pool(pool), comp(comp) {}
+
+    // 并行归并排序：两半并行排序，在原数组与缓冲区之间交替归并；
+    // 归并阶段按输出位置切块，用 co-rank 二分确定每块在两个输入中的起点，各块并行归并
+    void mergeSort(std::span<T> range, std::span<T> scratch = {});
+
+    // 并行快速排序：九数取中 + Hoare 分区，两侧作为独立任务并行处理，
+    // 递归过深或区间足够小时交给顺序的 pdqSort
+    void quickSort(std::span<T> range);
+
+    void resetCounters() { comparisonCount = 0; swapCount = 0; allocationCount = 0; }
+    size_t getComparisons() const { return comparisonCount; }
+    size_t getSwaps() const { return swapCount; }
+    size_t getAllocations() const { return allocationCount; }
+
+private:
+    ThreadPool& pool;
+    Compare comp;
+    std::atomic<size_t> comparisonCount{0};
+    std::atomic<size_t> swapCount{0};
+    std::atomic<size_t> allocationCount{0};
+
+    void absorb(const Engine& engine) {
+        if constexpr (Instrumentation::enabled) {
+            comparisonCount += engine.getComparisons();
+            swapCount += engine.getSwaps();
+        }
+    }
+    void addComparisons(size_t count) {
+        if constexpr (Instrumentation::enabled) comparisonCount += count;
+    }
+    void addSwaps(size_t count) {
+        if constexpr (Instrumentation::enabled) swapCount += count;
+    }
+
+    void mergeSortRecursive(T* a, T* b, size_t n, bool resultInB);
+    void parallelMerge(T* left, size_t leftSize, T* right, size_t rightSize, T* dst);
+    size_t coRank(size_t k, const T* left, size_t leftSize, const T* right, size_t rightSize);
+    void quickSortRecursive(T* a, size_t n, int depthLimit);
+    size_t partition(T* a, size_t n);
+};
+
+template <typename T, typename Compare, typename Instrumentation>
+void ParallelSorter<T, Compare, Instrumentation>::mergeSort(std::span<T> range, std::span<T> scratch) {
+    resetCounters();
+    if (range.size() < 2) return;
+
+    std::vector<T> ownBuffer;
+    if (scratch.size() < range.size()) {
+        ownBuffer.resize(range.size());
+        allocationCount++;
+        scratch = ownBuffer;
+    }
+    mergeSortRecursive(range.data(), scratch.data(), range.size(), false);
+}
+
+// 排序 a[0, n)，resultInB 为 true 时结果写入 b，否则留在 a；另一块作为缓冲区
+template <typename T, typename Compare, typename Instrumentation>
+void ParallelSorter<T, Compare, Instrumentation>::mergeSortRecursive(T* a, T* b, size_t n, bool resultInB) {
+    if (n <= kSequentialThreshold) {
+        Engine engine(comp);
+        engine.mergeSort(std::span<T>(a, n), std::span<T>(b, n));
+        absorb(engine);
+        if (resultInB) std::move(a, a + n, b);
+        return;
+    }
+
+    // 两半的结果放到与目标相反的缓冲区，再归并回目标
+    size_t mid = n / 2;
+    {
+        TaskGroup group(pool);
+        group.run([=, this]() { mergeSortRecursive(a, b, mid, !resultInB); });
+        mergeSortRecursive(a + mid, b + mid, n - mid, !resultInB);
+        group.wait();
+    }
+
+    T* src = resultInB ? a : b;
+    T* dst = resultInB ? b : a;
+    parallelMerge(src, mid, src + mid, n - mid, dst);
+}
+
+// co-rank：返回 i，使得 left[0, i) 与 right[0, k - i) 恰好构成归并结果的前 k 个元素
+// （相等元素左侧优先，保持稳定性）
+template <typename T, typename Compare, typename Instrumentation>
+size_t ParallelSorter<T, Compare, Instrumentation>::coRank(size_t k, const T* left, size_t leftSize,
+                                                           const T* right, size_t rightSize) {
+    size_t low = k > rightSize ? k - rightSize : 0;
+    size_t high = std::min(k, leftSize);
+    size_t comparisons = 0;
+
+    while (true) {
+        size_t i = low + (high - low) / 2;
+        size_t j = k - i;
+        if (i < leftSize && j > 0 && (comparisons++, !comp(right[j - 1], left[i]))) {
+            low = i + 1;
+        } else if (i > 0 && j < rightSize && (comparisons++, comp(right[j], left[i - 1]))) {
+            high = i - 1;
+        } else {
+            addComparisons(comparisons);
+            return i;
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+void ParallelSorter<T, Compare, Instrumentation>::parallelMerge(T* left, size_t leftSize, T* right, size_t rightSize, T* dst) {
+    size_t total = leftSize + rightSize;
+    size_t chunks = std::min((total + kSequentialThreshold - 1) / kSequentialThreshold, pool.getThreadCount() * 4);
+    chunks = std::max<size_t>(chunks, 1);
+
+    auto mergeChunk = [=, this](size_t chunk) {
+        size_t k0 = total * chunk / chunks;
+        size_t k1 = total * (chunk + 1) / chunks;
+        size_t i = coRank(k0, left, leftSize, right, rightSize);
+        size_t iEnd = coRank(k1, left, leftSize, right, rightSize);
+        size_t j = k0 - i;
+        size_t jEnd = k1 - iEnd;
+
+        size_t comparisons = 0;
+        T* out = dst + k0;
+        while (i < iEnd && j < jEnd) {
+            comparisons++;
+            if (!comp(right[j], left[i])) *out++ = std::move(left[i++]);
+            else *out++ = std::move(right[j++]);
+        }
+        out = std::move(left + i, left + iEnd, out);
+        std::move(right + j, right + jEnd, out);
+        addComparisons(comparisons);
+    };
+
+    TaskGroup group(pool);
+    for (size_t chunk = 1; chunk < chunks; chunk++) {
+        group.run([=]() { mergeChunk(chunk); });
+    }
+    mergeChunk(0);
+    group.wait();
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+void ParallelSorter<T, Compare, Instrumentation>::quickSort(std::span<T> range) {
+    resetCounters();
+    if (range.size() < 2) return;
+    quickSortRecursive(range.data(), range.size(), 2 * floorLog2(range.size()));
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+void ParallelSorter<T, Compare, Instrumentation>::quickSortRecursive(T* a, size_t n, int depthLimit) {
+    if (n <= kSequentialThreshold || depthLimit == 0) {
+        Engine engine(comp);
+        engine.pdqSort(std::span<T>(a, n));
+        absorb(engine);
+        return;
+    }
+
+    size_t p = partition(a, n);
+
+    TaskGroup group(pool);
+    group.run([=, this]() { quickSortRecursive(a, p + 1, depthLimit - 1); });
+    quickSortRecursive(a + p + 1, n - p - 1, depthLimit - 1);
+    group.wait();
+}
+
+// Hoare 分区：九数取中得到的枢轴先换到 a[0]，返回 j 使 a[0, j] <= 枢轴 <= a[j + 1, n)，
+// 且两侧都非空
+template <typename T, typename Compare, typename Instrumentation>
+size_t ParallelSorter<T, Compare, Instrumentation>::partition(T* a, size_t n) {
+    size_t comparisons = 0;
+    size_t swaps = 0;
+    auto less = [&](const T& x, const T& y) {
+        comparisons++;
+        return comp(x, y);
+    };
+    auto median3 = [&](size_t x, size_t y, size_t z) {
+        if (less(a[y], a[x])) std::swap(x, y);
+        if (less(a[z], a[y])) std::swap(y, z);
+        if (less(a[y], a[x])) std::swap(x, y);
+        return y;
+    };
+
+    size_t step = n / 8;
+    size_t mid = n / 2;
+    size_t pivotIndex = median3(median3(0, step, 2 * step),
+                                median3(mid - step, mid, mid + step),
+                                median3(n - 1 - 2 * step, n - 1 - step, n - 1));
+    std::swap(a[0], a[pivotIndex]);
+    T pivot = a[0];
+
+    std::ptrdiff_t i = -1;
+    std::ptrdiff_t j = static_cast<std::ptrdiff_t>(n);
+    while (true) {
+        do { i++; } while (less(a[i], pivot));
+        do { j--; } while (less(pivot, a[j]));
+        if (i >= j) break;
+        std::swap(a[i], a[j]);
+        swaps++;
+    }
+
+    addComparisons(comparisons);
+    addSwaps(swaps);
+    return static_cast<size_t>(j);
+}
+
+// 一次排序的操作计数。基数排序不做比较，以遍数和搬移字节数代替；
+// NoInstrumentation 下比较/交换恒为 0
+struct SortOperationCounts {
+    size_t comparisons = 0;
+    size_t swaps = 0;
+    size_t allocations = 0;
+    size_t passes = 0;
+    size_t bytesMoved = 0;
+};
+
+// 唯一的算法分发入口（SortingSystem、基准测试、外部排序、数据集排序共用），比较器与插桩策略为模板参数：
+// 并行算法在 pool 上由 ParallelSorter 执行，pool 为空时抛出 std::invalid_argument；
+// 其余算法交给 SortingEngine::sort（不支持的组合同样抛出，不会悄悄换成别的算法）。
+// 归并排序、powersort、并行归并与 LSD 基数排序使用 scratch 作缓冲区，不足时自行申请
+template <typename T, typename Compare = std::less<T>, typename Instrumentation = CountingInstrumentation>
+SortOperationCounts dispatchSort(SortAlgorithm algorithm, std::span<T> values, std::span<T> scratch = {},
+                                 ThreadPool* pool = nullptr, Compare comp = Compare()) {
+    SortOperationCounts counts;
+    if (isParallelSortAlgorithm(algorithm)) {
+        if (!pool) throw std::invalid_argument(std::string(sortAlgorithmName(algorithm)) + " 需要线程池");
+        ParallelSorter<T, Compare, Instrumentation> sorter(*pool, comp);
+        if (algorithm == SortAlgorithm::ParallelMergeSort) sorter.mergeSort(values, scratch);
+        else sorter.quickSort(values);
+        counts.comparisons = sorter.getComparisons();
+        counts.swaps = sorter.getSwaps();
+        counts.allocations = sorter.getAllocations();
+        return counts;
+    }
+
+    SortingEngine<T, Compare, Instrumentation> engine(comp);
+    engine.sort(algorithm, values, scratch);
+    counts.comparisons = engine.getComparisons();
+    counts.swaps = engine.getSwaps();
+    counts.allocations = engine.getAllocations();
+    counts.passes = engine.getRadixStats().passes;
+    counts.bytesMoved = engine.getRadixStats().bytesMoved;
+    return counts;
+}
+
+#endif // PARALLEL_SORT_H
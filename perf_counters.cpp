@@ -0,0 +1,156 @@
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* hardwareCounterName(HardwareCounter counter) {
+    switch (counter) {
+        case HardwareCounter::Cycles:       return "cycles";
+        case HardwareCounter::Instructions: return "instructions";
+        case HardwareCounter::BranchMisses: return "branch-misses";
+        case HardwareCounter::L1DMisses:    return "L1d-misses";
+        case HardwareCounter::LLCMisses:    return "LLC-misses";
+        case HardwareCounter::DTLBMisses:   return "dTLB-misses";
+    }
+    return "unknown";
+}
+
+double HardwareCounters::ipc() const {
+    if (!has(HardwareCounter::Cycles) || !has(HardwareCounter::Instructions) || get(HardwareCounter::Cycles) == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(get(HardwareCounter::Instructions)) / static_cast<double>(get(HardwareCounter::Cycles));
+}
+
+HardwareCounters& HardwareCounters::operator+=(const HardwareCounters& other) {
+    // 累加时只保留两边都有效的计数器
+    availableMask = any() ? (availableMask & other.availableMask) : other.availableMask;
+    for (size_t i = 0; i < kHardwareCounterCount; i++) values[i] += other.values[i];
+    return *this;
+}
+
+HardwareCounters HardwareCounters::dividedBy(uint64_t runs) const {
+    HardwareCounters result = *this;
+    if (runs > 1) {
+        for (auto& value : result.values) value /= runs;
+    }
+    return result;
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct CounterEvent {
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr uint64_t cacheMiss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+// 与 HardwareCounter 枚举顺序一致
+constexpr CounterEvent kEvents[kHardwareCounterCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB)},
+};
+
+int openCounter(const CounterEvent& event) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1：统计当前线程，不限 CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+} // namespace
+
+PerfCounterGroup::PerfCounterGroup() {
+    int firstError = 0;
+    for (size_t i = 0; i < kHardwareCounterCount; i++) {
+        fds[i] = openCounter(kEvents[i]);
+        if (fds[i] < 0 && firstError == 0) firstError = errno;
+    }
+    if (!available()) {
+        reason = std::string("perf_event_open 失败: ") + std::strerror(firstError);
+        if (firstError == EACCES || firstError == EPERM) {
+            reason += "（可尝试降低 /proc/sys/kernel/perf_event_paranoid）";
+        }
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    for (int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool PerfCounterGroup::available() const {
+    for (int fd : fds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+void PerfCounterGroup::start() {
+    for (int fd : fds) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+HardwareCounters PerfCounterGroup::stop() {
+    for (int fd : fds) {
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    HardwareCounters counters;
+    for (size_t i = 0; i < kHardwareCounterCount; i++) {
+        if (fds[i] < 0) continue;
+        uint64_t buffer[3]; // value, time_enabled, time_running
+        if (read(fds[i], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer)) || buffer[2] == 0) continue;
+
+        double scale = buffer[2] < buffer[1] ? static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]) : 1.0;
+        counters.values[i] = static_cast<uint64_t>(static_cast<double>(buffer[0]) * scale);
+        counters.availableMask |= 1u << i;
+    }
+    return counters;
+}
+
+#else
+
+PerfCounterGroup::PerfCounterGroup() : reason("硬件计数器仅支持 Linux（perf_event_open）") {
+    fds.fill(-1);
+}
+
+PerfCounterGroup::~PerfCounterGroup() = default;
+
+bool PerfCounterGroup::available() const {
+    return false;
+}
+
+void PerfCounterGroup::start() {}
+
+HardwareCounters PerfCounterGroup::stop() {
+    return HardwareCounters();
+}
+
+#endif // __linux__
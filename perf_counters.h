@@ -0,0 +1,63 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 硬件性能计数器（Linux perf_event_open）
+// 每个计数器单独打开，某个事件不受支持时只缺这一项；非 Linux 平台或权限不足时全部不可用，
+// 排序与计时照常进行。计数只覆盖调用 start()/stop() 的线程（并行算法的工作线程不计入）。
+
+enum class HardwareCounter {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1DMisses,
+    LLCMisses,
+    DTLBMisses
+};
+
+inline constexpr size_t kHardwareCounterCount = 6;
+
+const char* hardwareCounterName(HardwareCounter counter);
+
+struct HardwareCounters {
+    std::array<uint64_t, kHardwareCounterCount> values{};
+    uint32_t availableMask = 0; // 第 i 位表示 values[i] 有效
+
+    bool has(HardwareCounter counter) const { return availableMask & (1u << static_cast<size_t>(counter)); }
+    bool any() const { return availableMask != 0; }
+    uint64_t get(HardwareCounter counter) const { return values[static_cast<size_t>(counter)]; }
+    double ipc() const;
+
+    HardwareCounters& operator+=(const HardwareCounters& other);
+    // 多次运行累加后取平均
+    HardwareCounters dividedBy(uint64_t runs) const;
+};
+
+class PerfCounterGroup {
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    // 至少有一个计数器可用
+    bool available() const;
+    // 全部不可用时的原因（如权限不足），可用时为空
+    const std::string& unavailableReason() const { return reason; }
+
+    // 清零并开始计数
+    void start();
+    // 停止计数并读取；因计数器复用而未全程运行的按运行时间比例放大
+    HardwareCounters stop();
+
+private:
+    std::array<int, kHardwareCounterCount> fds;
+    std::string reason;
+};
+
+#endif // PERF_COUNTERS_H
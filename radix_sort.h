@@ -0,0 +1,246 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "sorting_network.h"
+
+// 可用基数排序的键类型：整数（不含 bool）与浮点数
+template <typename T>
+concept RadixScalar = (std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>;
+
+// 记录类型：按成员函数 sortKey() 返回的标量键排序（如 sort_record.h 的 SortRecord）
+template <typename T>
+concept RadixKeyed = requires(const T& value) {
+    { value.sortKey() } -> RadixScalar;
+};
+
+template <typename T>
+concept RadixSortable = RadixScalar<T> || RadixKeyed<T>;
+
+// 键变换：把 T 映射为无符号整数，且映射保持 T 的升序
+//   有符号整数：翻转符号位
+//   浮点数：负数翻转全部位，非负数只翻转符号位（-0.0 排在 +0.0 之前，NaN 排在两端）
+template <RadixSortable T>
+struct RadixKeyTraits {
+    using Key = std::conditional_t<(sizeof(T) <= 4), uint32_t, uint64_t>;
+    static constexpr int kBits = static_cast<int>(sizeof(T) * 8);
+
+    static Key toKey(T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+            Bits bits = std::bit_cast<Bits>(value);
+            Bits signBit = Bits(1) << (kBits - 1);
+            return static_cast<Key>((bits & signBit) ? ~bits : (bits | signBit));
+        } else if constexpr (std::is_signed_v<T>) {
+            using Unsigned = std::make_unsigned_t<T>;
+            return static_cast<Key>(static_cast<Unsigned>(value) ^ (Unsigned(1) << (kBits - 1)));
+        } else {
+            return static_cast<Key>(value);
+        }
+    }
+};
+
+// 记录类型：对 sortKey() 做同样的变换
+template <RadixKeyed T>
+struct RadixKeyTraits<T> : RadixKeyTraits<decltype(std::declval<const T&>().sortKey())> {
+    using Base = RadixKeyTraits<decltype(std::declval<const T&>().sortKey())>;
+
+    static typename Base::Key toKey(const T& value) { return Base::toKey(value.sortKey()); }
+};
+
+// 基数排序统计（替代比较次数）
+struct RadixSortStats {
+    size_t passes = 0;        // 实际执行的分配遍数
+    size_t skippedPasses = 0; // 因该位全部相同而跳过的遍数
+    size_t bytesMoved = 0;    // 元素搬移的总字节数
+    size_t allocations = 0;
+};
+
+// LSD / MSD 基数排序
+template <RadixSortable T>
+class RadixSorter {
+public:
+    using Traits = RadixKeyTraits<T>;
+    using Key = typename Traits::Key;
+
+    // 数据量达到该阈值时 LSD 自动改用 11 位数字（32 位键只需 3 遍）
+    static constexpr size_t kWideDigitThreshold = 1 << 16;
+    // MSD 中小于该长度的桶改用插入排序（int32/int64/float 使用 SIMD 排序网络）
+    static constexpr size_t kMsdInsertionThreshold = 32;
+
+    // digitBits 为 LSD 每遍的位数（8 或 11），0 表示按数据量自动选择
+    explicit RadixSorter(int digitBits = 0) : digitBits(digitBits) {}
+
+    // LSD 基数排序：一次读遍历统计所有位的直方图，跳过所有元素该位相同的遍，
+    // 在原数组与缓冲区之间交替分配；scratch 由调用方提供时不申请缓冲区
+    void lsdSort(std::span<T> range, std::span<T> scratch = {});
+
+    // MSD 基数排序（American flag sort）：按 8 位数字原地循环置换，不需要缓冲区
+    void msdSort(std::span<T> range);
+
+    const RadixSortStats& getStats() const { return stats; }
+
+private:
+    int digitBits;
+    RadixSortStats stats;
+    int lowestShift = 0; // MSD 实际处理到的最低位
+
+    void msdSortRecursive(T* a, size_t n, int shift);
+    void insertionSortByKey(T* a, size_t n);
+};
+
+template <RadixSortable T>
+void RadixSorter<T>::lsdSort(std::span<T> range, std::span<T> scratch) {
+    stats = RadixSortStats();
+    size_t n = range.size();
+    if (n < 2) return;
+
+    int bits = digitBits > 0 ? digitBits : (n >= kWideDigitThreshold ? 11 : 8);
+    int passCount = (Traits::kBits + bits - 1) / bits;
+    size_t buckets = size_t(1) << bits;
+    Key mask = static_cast<Key>(buckets - 1);
+
+    // 所有位的直方图在同一次读遍历中统计完成，各位的计数互不依赖
+    std::vector<size_t> histograms(static_cast<size_t>(passCount) * buckets, 0);
+    stats.allocations++;
+    for (const T& value : range) {
+        Key key = Traits::toKey(value);
+        for (int pass = 0; pass < passCount; pass++) {
+            histograms[pass * buckets + ((key >> (pass * bits)) & mask)]++;
+        }
+    }
+
+    std::vector<T> ownBuffer;
+    if (scratch.size() < n) {
+        ownBuffer.resize(n);
+        stats.allocations++;
+        scratch = ownBuffer;
+    }
+
+    T* src = range.data();
+    T* dst = scratch.data();
+    for (int pass = 0; pass < passCount; pass++) {
+        size_t* counts = &histograms[pass * buckets];
+        int shift = pass * bits;
+
+        // 所有元素该位相同，本遍不改变顺序
+        if (counts[(Traits::toKey(src[0]) >> shift) & mask] == n) {
+            stats.skippedPasses++;
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t b = 0; b < buckets; b++) {
+            size_t count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < n; i++) {
+            dst[counts[(Traits::toKey(src[i]) >> shift) & mask]++] = std::move(src[i]);
+        }
+
+        std::swap(src, dst);
+        stats.passes++;
+        stats.bytesMoved += n * sizeof(T);
+    }
+
+    if (src != range.data()) {
+        std::move(src, src + n, range.data());
+        stats.bytesMoved += n * sizeof(T);
+    }
+}
+
+template <RadixSortable T>
+void RadixSorter<T>::msdSort(std::span<T> range) {
+    stats = RadixSortStats();
+    if (range.size() < 2) return;
+    lowestShift = Traits::kBits;
+    msdSortRecursive(range.data(), range.size(), Traits::kBits - 8);
+    // 以处理过的数字位数作为遍数
+    stats.passes = lowestShift < Traits::kBits ? static_cast<size_t>((Traits::kBits - lowestShift) / 8) : 0;
+}
+
+template <RadixSortable T>
+void RadixSorter<T>::msdSortRecursive(T* a, size_t n, int shift) {
+    if (n <= kMsdInsertionThreshold) {
+        insertionSortByKey(a, n);
+        return;
+    }
+
+    auto digit = [shift](const T& value) {
+        return static_cast<size_t>((Traits::toKey(value) >> shift) & 0xFF);
+    };
+
+    size_t counts[256] = {};
+    for (size_t i = 0; i < n; i++) counts[digit(a[i])]++;
+
+    // 所有元素该位相同：直接处理下一位
+    if (counts[digit(a[0])] == n) {
+        stats.skippedPasses++;
+        if (shift > 0) msdSortRecursive(a, n, shift - 8);
+        return;
+    }
+
+    size_t head[256];
+    size_t tail[256];
+    size_t offset = 0;
+    for (size_t b = 0; b < 256; b++) {
+        head[b] = offset;
+        offset += counts[b];
+        tail[b] = offset;
+    }
+
+    // 循环置换：把每个元素直接换到其所属桶的下一个空位
+    size_t moves = 0;
+    for (size_t b = 0; b < 256; b++) {
+        while (head[b] < tail[b]) {
+            T value = std::move(a[head[b]]);
+            size_t d = digit(value);
+            while (d != b) {
+                std::swap(value, a[head[d]++]);
+                d = digit(value);
+                moves++;
+            }
+            a[head[b]++] = std::move(value);
+            moves++;
+        }
+    }
+    lowestShift = std::min(lowestShift, shift);
+    stats.bytesMoved += moves * sizeof(T);
+
+    if (shift == 0) return;
+    size_t start = 0;
+    for (size_t b = 0; b < 256; b++) {
+        if (counts[b] > 1) msdSortRecursive(a + start, counts[b], shift - 8);
+        start += counts[b];
+    }
+}
+
+template <RadixSortable T>
+void RadixSorter<T>::insertionSortByKey(T* a, size_t n) {
+    if constexpr (SortingNetworkSortable<T>) {
+        sortingNetworkSort(a, n);
+        stats.bytesMoved += n * sizeof(T);
+        return;
+    }
+    for (size_t i = 1; i < n; i++) {
+        T value = std::move(a[i]);
+        Key key = Traits::toKey(value);
+        size_t j = i;
+        while (j > 0 && key < Traits::toKey(a[j - 1])) {
+            a[j] = std::move(a[j - 1]);
+            j--;
+            stats.bytesMoved += sizeof(T);
+        }
+        a[j] = std::move(value);
+    }
+}
+
+#endif // RADIX_SORT_H
@@ -0,0 +1,225 @@
+#include "replay_experiments.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <stdexcept>
+#include "benchmark.h"
+#include "replay_scheduler.h"
+#include "sort_trace.h"
+#include "sorting_system.h"
+
+void runTraceRecording(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input) {
+    SortTrace trace = recordSortTrace(algorithm, input);
+
+    std::vector<int> work(input.begin(), input.end());
+    auto start = std::chrono::steady_clock::now();
+    SortingEngine<int, std::less<int>, NoInstrumentation>().sort(algorithm, work);
+    double plainMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::array<size_t, 4> byType{};
+    for (size_t c = 0; c < trace.events.chunkCount(); c++) {
+        for (const TraceEvent& event : trace.events.chunk(c)) byType[static_cast<size_t>(event.type)]++;
+    }
+
+    TraceReplayer replayer(trace);
+    start = std::chrono::steady_clock::now();
+    replayer.advance(trace.events.size());
+    double replayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    bool replayed = std::equal(work.begin(), work.end(), replayer.values().begin());
+
+    out << "\n======= " << sortAlgorithmName(algorithm) << " 事件记录（" << input.size() << " 个元素）=======" << std::endl;
+    out << "事件总数: " << trace.events.size() << "（比较 " << byType[0] << "，交换 " << byType[1]
+        << "，移动 " << byType[2] << "，写入 " << byType[3] << "）" << std::endl;
+    out << "缓冲区: " << std::fixed << std::setprecision(2) << trace.events.allocatedBytes() / 1048576.0
+        << " MiB（每个事件 " << sizeof(TraceEvent) << " 字节）" << std::endl;
+    out << "排序耗时: 不插桩 " << std::setprecision(3) << plainMs << " ms，记录事件 " << trace.recordMs << " ms" << std::endl;
+    out << "回放耗时: " << replayMs << " ms";
+    if (replayMs > 0) out << "（" << std::setprecision(1) << trace.events.size() / replayMs / 1000.0 << " M 事件/秒）";
+    out << std::endl;
+    out << "回放结果与排序结果" << (replayed ? "一致" : "不一致") << std::endl;
+
+    // 数据较少时逐步显示每次改变数组的事件
+    const size_t maxShownElements = 20;
+    const size_t maxShownSteps = 200;
+    if (input.size() > maxShownElements) return;
+    out << "\n逐步回放（仅显示改变数组的事件）:" << std::endl;
+    replayer.rewind();
+    size_t shown = 0;
+    while (!replayer.done() && shown < maxShownSteps) {
+        const TraceEvent& event = replayer.step();
+        if (event.type == SortEvent::Type::Compare) continue;
+        out << std::setw(6) << replayer.position() << ": ";
+        for (int value : replayer.values()) out << value << " ";
+        out << std::endl;
+        shown++;
+    }
+    if (!replayer.done()) out << "...（其余 " << replayer.size() - replayer.position() << " 个事件未显示）" << std::endl;
+}
+
+void runTraceFileRecording(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input,
+                           const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    TraceFileHeader header = recordSortTraceFile(algorithm, input, path);
+    double recordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    uint64_t fileBytes = std::filesystem::file_size(path);
+
+    out << "\n已写入 " << path << std::endl;
+    out << "事件: " << header.eventCount << "，关键帧: " << header.keyframeCount
+        << "（每 " << header.keyframeInterval << " 个事件一个）" << std::endl;
+    out << "文件大小: " << std::fixed << std::setprecision(2) << fileBytes / 1048576.0 << " MiB";
+    if (header.eventCount > 0) {
+        out << "（平均每个事件 " << static_cast<double>(fileBytes) / header.eventCount
+            << " 字节，内存中为 " << sizeof(TraceEvent) << " 字节）";
+    }
+    out << std::endl;
+    out << "排序并写入耗时: " << std::setprecision(3) << recordMs << " ms" << std::endl;
+    out << std::defaultfloat;
+}
+
+void showTraceFileStep(std::ostream& out, TraceFileReader& reader, uint64_t target) {
+    const size_t maxShownElements = 40;
+    auto start = std::chrono::steady_clock::now();
+    reader.seek(target);
+    double seekMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::span<const int> values = reader.values();
+    out << "第 " << reader.position() << " 步（定位耗时 " << std::fixed << std::setprecision(3) << seekMs << " ms）: ";
+    for (size_t i = 0; i < std::min(values.size(), maxShownElements); i++) out << values[i] << " ";
+    if (values.size() > maxShownElements) out << "...";
+    out << std::defaultfloat << std::endl;
+}
+
+void runReplaySimulation(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input,
+                         double framesPerSecond, double speed) {
+    if (!(framesPerSecond > 0) || !(speed > 0)) throw std::invalid_argument("帧率和速度必须大于 0");
+    SortTrace trace = recordSortTrace(algorithm, input);
+    TraceReplayer replayer(trace);
+    ReplayScheduler<ManualReplayClock> scheduler(framesPerSecond, speed);
+    scheduler.start();
+
+    const size_t maxFrames = 10000000;
+    ReplayFrame frame;
+    size_t frames = 0, redrawFrames = 0, maxEvents = 0, dirtyColumns = 0, dirtyRanges = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (!frame.finished && frames < maxFrames) {
+        scheduler.getClock().advance(scheduler.untilNextFrame());
+        if (scheduler.nextFrame(replayer, frame)) redrawFrames++;
+        frames++;
+        maxEvents = std::max(maxEvents, frame.events);
+        dirtyColumns += frame.dirty.count();
+        dirtyRanges += frame.dirty.ranges().size();
+    }
+    double simulateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double n = static_cast<double>(trace.initial.size());
+    double frameCount = static_cast<double>(std::max<size_t>(frames, 1));
+    out << std::fixed << std::setprecision(2);
+    out << "\n" << sortAlgorithmName(algorithm) << "：" << trace.events.size() << " 个事件，实际帧率 "
+        << scheduler.getFramesPerSecond() << "，每秒 " << scheduler.eventsPerSecond() << " 个事件" << std::endl;
+    if (!frame.finished) {
+        out << "已模拟 " << maxFrames << " 帧仍未回放完（位置 " << frame.position << "），停止模拟" << std::endl;
+    }
+    out << "帧数: " << frames << "（需要重绘 " << redrawFrames << " 帧），回放时长: "
+        << frameCount / scheduler.getFramesPerSecond() << " s" << std::endl;
+    out << "每帧事件: 平均 " << static_cast<double>(trace.events.size()) / frameCount << "，最多 " << maxEvents << std::endl;
+    out << "每帧脏区间: 平均 " << dirtyRanges / frameCount << " 段，覆盖 " << dirtyColumns / frameCount
+        << " 列（共 " << trace.initial.size() << " 列，占 " << (n > 0 ? 100.0 * dirtyColumns / frameCount / n : 0.0)
+        << "%）" << std::endl;
+    out << "逐事件重绘（每个事件至少 1 ms）需要至少 " << trace.events.size() / 1000.0 << " s" << std::endl;
+    out << "模拟耗时: " << simulateMs << " ms" << std::endl;
+    out << std::defaultfloat;
+    if (frame.finished) {
+        std::span<const int> values = replayer.values();
+        out << "回放结果" << (std::is_sorted(values.begin(), values.end()) ? "已排序" : "未排序（错误）") << std::endl;
+    }
+}
+
+void runFrameExport(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input,
+                    const std::string& directory, const FrameExportOptions& options) {
+    SortTrace trace = recordSortTrace(algorithm, input);
+    FrameExportResult result = exportTraceFrames(trace, directory, options);
+
+    out << "\n已导出 " << result.frames << " 帧到 " << directory << "，回放了 " << result.events << " / "
+        << trace.events.size() << " 个事件" << (result.finished ? "" : "（达到帧数上限，未回放完）") << std::endl;
+    out << std::fixed << std::setprecision(3);
+    out << "总大小: " << result.bytes / 1048576.0 << " MiB" << std::endl;
+    out << "光栅化: " << result.renderMs << " ms（每帧 " << result.renderMs / result.frames << " ms，约 "
+        << std::setprecision(0) << (result.renderMs > 0 ? result.frames * 1000.0 / result.renderMs : 0.0)
+        << " 帧/秒）" << std::endl;
+    out << std::setprecision(3) << "编码与写文件: " << result.writeMs << " ms" << std::endl;
+    out << std::defaultfloat;
+}
+
+void runIncrementalRenderBenchmark(std::ostream& out, SortAlgorithm algorithm, double speed,
+                                   const std::vector<size_t>& sizes) {
+    if (!(speed > 0)) throw std::invalid_argument("速度必须大于 0");
+
+    const int width = 1280, height = 720;
+    const double framesPerSecond = 60.0;
+    const size_t maxFrames = 300;
+    // 只记录这些帧会用到的事件
+    const size_t eventLimit = static_cast<size_t>(speed * ReplayScheduler<>::kBaseEventsPerSecond / framesPerSecond *
+                                                  (maxFrames + ReplayScheduler<>::kMaxCatchUpFrames)) + 1;
+
+    out << "\n" << sortAlgorithmName(algorithm) << "，画布 " << width << "x" << height << "，" << framesPerSecond
+        << " fps，每帧约 " << std::fixed << std::setprecision(0)
+        << speed * ReplayScheduler<>::kBaseEventsPerSecond / framesPerSecond << " 个事件，最多 " << maxFrames
+        << " 帧：" << std::endl;
+    out << std::left << std::setw(10) << "n" << std::setw(8) << "帧数" << std::setw(14) << "脏列占比"
+        << std::setw(16) << "整帧(ms/帧)" << std::setw(16) << "增量(ms/帧)" << std::setw(10) << "加速比"
+        << "结果" << std::endl;
+    out << std::string(80, '-') << std::endl;
+
+    const size_t quadraticSizeLimit = BenchmarkConfig().quadraticSizeLimit;
+    for (size_t size : sizes) {
+        // 事件上限只限制保存的事件，排序本身仍会跑完
+        if (size > quadraticSizeLimit && BenchmarkRunner::isQuadraticCase(algorithm, DataPattern::Random)) {
+            out << std::left << std::setw(10) << size << "跳过（O(n²) 算法）" << std::endl;
+            continue;
+        }
+        std::vector<int> data = SortingSystem::generateTestData(size, DataPattern::Random);
+        SortTrace trace = recordSortTrace(algorithm, data, eventLimit);
+        BarValueRange range = barValueRange(trace.initial);
+        TraceReplayer replayer(trace);
+        ReplayScheduler<ManualReplayClock> scheduler(framesPerSecond, speed);
+        scheduler.start();
+
+        Framebuffer fullFrame(width, height), incrementalFrame(width, height);
+        BarChartRenderer fullRenderer, incrementalRenderer;
+        ReplayFrame frame;
+        double fullMs = 0.0, incrementalMs = 0.0;
+        size_t frames = 0, redrawnColumns = 0;
+        bool identical = true;
+        // 第一帧两种方式都是整帧绘制，不计入
+        incrementalRenderer.renderDirty(incrementalFrame, replayer.values(), range, frame.dirty);
+        while (frames < maxFrames && !frame.finished) {
+            scheduler.getClock().advance(scheduler.untilNextFrame());
+            scheduler.nextFrame(replayer, frame);
+
+            auto start = std::chrono::steady_clock::now();
+            fullRenderer.render(fullFrame, replayer.values(), range, frame.highlight1, frame.highlight2);
+            auto middle = std::chrono::steady_clock::now();
+            const DirtyRanges& columns = incrementalRenderer.renderDirty(incrementalFrame, replayer.values(), range,
+                                                                         frame.dirty, frame.highlight1,
+                                                                         frame.highlight2);
+            auto end = std::chrono::steady_clock::now();
+
+            fullMs += std::chrono::duration<double, std::milli>(middle - start).count();
+            incrementalMs += std::chrono::duration<double, std::milli>(end - middle).count();
+            redrawnColumns += columns.count();
+            frames++;
+        }
+        std::span<const Rgba> a = fullFrame.data(), b = incrementalFrame.data();
+        identical = std::equal(a.begin(), a.end(), b.begin());
+
+        double frameCount = static_cast<double>(std::max<size_t>(frames, 1));
+        out << std::left << std::setw(10) << size << std::setw(8) << frames << std::setw(14) << std::fixed
+            << std::setprecision(2) << 100.0 * redrawnColumns / frameCount / width << std::setw(16)
+            << std::setprecision(4) << fullMs / frameCount << std::setw(16) << incrementalMs / frameCount
+            << std::setw(10) << std::setprecision(1) << (incrementalMs > 0 ? fullMs / incrementalMs : 0.0)
+            << (identical ? "一致" : "不一致（错误）") << std::endl;
+    }
+    out << std::defaultfloat;
+}
@@ -0,0 +1,38 @@
+#ifndef REPLAY_EXPERIMENTS_H
+#define REPLAY_EXPERIMENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+#include "frame_renderer.h"
+#include "sorting_engine.h"
+#include "trace_file.h"
+
+// 排序事件记录、回放与绘制的无界面实验：结果写到 out，交互菜单与命令行的 --experiment 共用。
+// algorithm 不能是并行算法（事件顺序不确定，recordSortTrace 会拒绝）；参数无效时抛出 std::invalid_argument
+
+// 以全速记录 input 上的排序事件，统计事件构成与记录/回放开销；数据较少时逐步列出回放过程
+void runTraceRecording(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input);
+
+// 排序时把事件流式写入压缩追踪文件 path，输出事件数、关键帧与文件大小
+void runTraceFileRecording(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input,
+                           const std::string& path);
+// 定位到第 target 步并输出该步的数组（只列前若干个元素）与定位耗时
+void showTraceFileStep(std::ostream& out, TraceFileReader& reader, uint64_t target);
+
+// 用手动时钟模拟 GUI 的按帧回放，统计帧数、每帧事件数与脏区间，不需要窗口
+void runReplaySimulation(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input,
+                         double framesPerSecond, double speed);
+
+// 记录排序后按帧软件光栅化，把图像序列写入 directory，不需要窗口
+void runFrameExport(std::ostream& out, SortAlgorithm algorithm, std::span<const int> input,
+                    const std::string& directory, const FrameExportOptions& options);
+
+// 在各规模的随机数据上按回放帧比较两种绘制方式的每帧耗时：整帧重画与只重画脏列（结果逐像素核对）
+void runIncrementalRenderBenchmark(std::ostream& out, SortAlgorithm algorithm, double speed,
+                                   const std::vector<size_t>& sizes);
+
+#endif // REPLAY_EXPERIMENTS_H
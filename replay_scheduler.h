@@ -0,0 +1,241 @@
+#ifndef REPLAY_SCHEDULER_H
+#define REPLAY_SCHEDULER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "sort_trace.h"
+
+// 按帧合并的回放调度：动画帧率与事件速率解耦。每帧按“经过的时间 × 事件速率”应用
+// 一批事件，只产生一次画面更新，并给出本帧内变化过的下标区间；
+// 回放不再受“每个事件一次重绘 + Sleep”的约束（原先最多约 1000 个事件/秒）。
+// 时钟作为策略参数按值持有（同 SortingEngine 的插桩策略），无界面环境下可用 ManualReplayClock 模拟。
+
+// 有序、互不相邻的脏下标区间 [begin, end)。区间数超过 maxRanges 时合并间隔最小的相邻两段，
+// 结果只会多覆盖、不会漏掉
+class DirtyRanges {
+public:
+    struct Range {
+        size_t begin;
+        size_t end;
+    };
+
+    static constexpr size_t kDefaultMaxRanges = 16;
+
+    explicit DirtyRanges(size_t maxRanges = kDefaultMaxRanges) : maxRanges(std::max<size_t>(1, maxRanges)) {
+        spans.reserve(this->maxRanges + 1);
+    }
+
+    void mark(size_t i) { mark(i, i + 1); }
+
+    void mark(size_t begin, size_t end) {
+        if (begin >= end) return;
+        // 连续的事件往往落在上一次合并的区间内
+        if (last < spans.size() && spans[last].begin <= begin && end <= spans[last].end) return;
+
+        // 第一个 end >= begin 的区间（相邻也合并）
+        auto it = std::lower_bound(spans.begin(), spans.end(), begin,
+                                   [](const Range& r, size_t b) { return r.end < b; });
+        if (it == spans.end() || it->begin > end) {
+            it = spans.insert(it, {begin, end});
+        } else {
+            it->begin = std::min(it->begin, begin);
+            it->end = std::max(it->end, end);
+            auto next = it + 1;
+            while (next != spans.end() && next->begin <= it->end) {
+                it->end = std::max(it->end, next->end);
+                ++next;
+            }
+            it = spans.erase(it + 1, next) - 1;
+        }
+        last = static_cast<size_t>(it - spans.begin());
+        if (spans.size() > maxRanges) coalesce();
+    }
+
+    void clear() {
+        spans.clear();
+        last = 0;
+    }
+
+    bool empty() const { return spans.empty(); }
+    std::span<const Range> ranges() const { return spans; }
+    size_t getMaxRanges() const { return maxRanges; }
+
+    // 覆盖的下标总数
+    size_t count() const {
+        size_t total = 0;
+        for (const Range& r : spans) total += r.end - r.begin;
+        return total;
+    }
+
+private:
+    std::vector<Range> spans;
+    size_t maxRanges;
+    size_t last = 0;
+
+    void coalesce() {
+        size_t best = 0;
+        for (size_t i = 1; i + 1 < spans.size(); i++) {
+            if (spans[i + 1].begin - spans[i].end < spans[best + 1].begin - spans[best].end) best = i;
+        }
+        spans[best].end = spans[best + 1].end;
+        spans.erase(spans.begin() + static_cast<std::ptrdiff_t>(best) + 1);
+        last = best;
+    }
+};
+
+// 真实时钟
+struct SteadyReplayClock {
+    using time_point = std::chrono::steady_clock::time_point;
+    time_point now() const { return std::chrono::steady_clock::now(); }
+};
+
+// 手动推进的时钟：测试或无界面模拟时由调用方推进时间
+struct ManualReplayClock {
+    using time_point = std::chrono::steady_clock::time_point;
+    time_point current{};
+
+    time_point now() const { return current; }
+    void advance(std::chrono::nanoseconds elapsed) { current += elapsed; }
+};
+
+// 一帧的结果。dirty 包含本帧改变过值的下标，以及上一帧和本帧的高亮下标（取消/绘制高亮也需要重绘）
+struct ReplayFrame {
+    size_t events = 0;   // 本帧应用的事件数
+    size_t position = 0; // 本帧结束后的回放位置
+    int highlight1 = -1; // 本帧最后一个事件涉及的下标（暂存值为 -1）
+    int highlight2 = -1;
+    DirtyRanges dirty;
+    bool finished = false;
+};
+
+template <typename Clock = SteadyReplayClock>
+class ReplayScheduler {
+public:
+    // 速度倍数 1 对应每秒 1000 个事件，即原先每个事件 Sleep(1) 时的上限
+    static constexpr double kBaseEventsPerSecond = 1000.0;
+    // 两帧间隔过长（卡顿、调试暂停）时最多补这么多帧的事件，避免突然跳过一大段
+    static constexpr int kMaxCatchUpFrames = 4;
+
+    explicit ReplayScheduler(double framesPerSecond = 60.0, double speed = 1.0, Clock clock = Clock())
+        : clock(std::move(clock)) {
+        setFramesPerSecond(framesPerSecond);
+        setSpeed(speed);
+    }
+
+    void setFramesPerSecond(double fps) { framesPerSecond = std::clamp(fps, 1.0, 1000.0); }
+    double getFramesPerSecond() const { return framesPerSecond; }
+    void setSpeed(double multiplier) { speed = std::max(0.0, multiplier); }
+    double getSpeed() const { return speed; }
+    double eventsPerSecond() const { return kBaseEventsPerSecond * speed; }
+
+    std::chrono::nanoseconds frameInterval() const {
+        return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / framesPerSecond));
+    }
+
+    Clock& getClock() { return clock; }
+    const Clock& getClock() const { return clock; }
+
+    // 从现在开始计时，清空未用完的事件配额和高亮
+    void start() {
+        lastFrame = clock.now();
+        nextDeadline = lastFrame + frameInterval();
+        credit = 0.0;
+        previous1 = previous2 = -1;
+        started = true;
+    }
+
+    // 暂停期间不积累事件配额
+    void pause() { paused = true; }
+    void resume() {
+        if (!paused) return;
+        paused = false;
+        lastFrame = clock.now();
+        nextDeadline = lastFrame + frameInterval();
+    }
+    bool isPaused() const { return paused; }
+
+    // 距下一帧到期的时间（已到期时为 0）
+    std::chrono::nanoseconds untilNextFrame() const {
+        if (!started) return std::chrono::nanoseconds(0);
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(nextDeadline - clock.now());
+        return std::max(remaining, std::chrono::nanoseconds(0));
+    }
+
+    // 应用自上一帧以来应得的事件（replayer 为 TraceReplayer 或 TraceFileReader），结果写入 frame，
+    // 复用其中 dirty 的存储。返回本帧是否需要重绘
+    template <typename Replayer>
+    bool nextFrame(Replayer& replayer, ReplayFrame& frame) {
+        if (!started) start();
+        auto now = clock.now();
+        auto interval = frameInterval();
+        auto elapsed = std::min(std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastFrame),
+                                interval * kMaxCatchUpFrames);
+        lastFrame = now;
+        // 落后时跳过错过的帧，不连续补帧
+        nextDeadline += interval;
+        if (nextDeadline <= now) nextDeadline = now + interval;
+
+        frame.dirty.clear();
+        frame.events = 0;
+        if (!paused) {
+            credit += std::chrono::duration<double>(elapsed).count() * eventsPerSecond();
+            auto budget = static_cast<size_t>(credit);
+            credit -= static_cast<double>(budget);
+
+            int first = previous1;
+            int second = previous2;
+            while (frame.events < budget && !replayer.done()) {
+                const TraceEvent& event = replayer.step();
+                first = event.first == kTraceTempIndex ? -1 : static_cast<int>(event.first);
+                second = event.second == kTraceTempIndex ? -1 : static_cast<int>(event.second);
+                switch (event.type) {
+                    case SortEvent::Type::Compare: break;
+                    case SortEvent::Type::Swap:
+                        if (first >= 0) frame.dirty.mark(event.first);
+                        if (second >= 0) frame.dirty.mark(event.second);
+                        break;
+                    case SortEvent::Type::Move:
+                    case SortEvent::Type::Write:
+                        if (first >= 0) frame.dirty.mark(event.first);
+                        break;
+                }
+                frame.events++;
+            }
+            if (replayer.done() && frame.events == 0) first = second = -1;
+            markHighlight(frame.dirty, previous1);
+            markHighlight(frame.dirty, previous2);
+            previous1 = first;
+            previous2 = second;
+            markHighlight(frame.dirty, first);
+            markHighlight(frame.dirty, second);
+        }
+        frame.highlight1 = previous1;
+        frame.highlight2 = previous2;
+        frame.position = replayer.position();
+        frame.finished = replayer.done();
+        return frame.events > 0 || !frame.dirty.empty();
+    }
+
+private:
+    Clock clock;
+    double framesPerSecond = 60.0;
+    double speed = 1.0;
+    double credit = 0.0;
+    typename Clock::time_point lastFrame{};
+    typename Clock::time_point nextDeadline{};
+    int previous1 = -1;
+    int previous2 = -1;
+    bool started = false;
+    bool paused = false;
+
+    static void markHighlight(DirtyRanges& dirty, int index) {
+        if (index >= 0) dirty.mark(static_cast<size_t>(index));
+    }
+};
+
+#endif // REPLAY_SCHEDULER_H
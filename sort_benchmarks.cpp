@@ -0,0 +1,353 @@
+#include "sort_benchmarks.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+#include "dataset_io.h"
+#include "external_sort.h"
+#include "parallel_sort.h"
+#include "perf_counters.h"
+#include "sort_record.h"
+#include "sorting_network.h"
+#include "sorting_system.h"
+
+namespace {
+
+// 同一输入排序 repetitions 次，取最快一次的耗时（ms）
+template <typename Instrumentation>
+double timeEngineSort(SortAlgorithm algorithm, const std::vector<int>& input, int repetitions) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; r++) {
+        std::vector<int> work = input;
+        SortingEngine<int, std::less<int>, Instrumentation> engine;
+        auto start = std::chrono::steady_clock::now();
+        engine.sort(algorithm, work);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// 堆排序：std::make_heap + std::sort_heap 与 2/4/8 叉堆在 int 和 16 字节记录上的耗时、比较次数与 LLC 缺失
+template <typename Element>
+void runHeapArityBenchmark(std::ostream& out, const char* elementName, const std::vector<int>& keys,
+                           PerfCounterGroup& perfCounters) {
+    const size_t size = keys.size();
+    const int repetitions = size >= 10000000 ? 1 : 3;
+    std::vector<Element> input;
+    if constexpr (std::is_same_v<Element, int>) input = keys;
+    else input = makeSortRecords<Element>(keys);
+    const double nLogN = static_cast<double>(size) * std::log2(static_cast<double>(size));
+
+    out << "\n" << elementName << "，" << size << " 个随机元素：" << std::endl;
+    out << std::left << std::setw(18) << "实现"
+        << std::setw(14) << "耗时(ms)"
+        << std::setw(18) << "比较/(n·log2n)"
+        << std::setw(16) << "LLC-miss/元素" << std::endl;
+    out << std::string(66, '-') << std::endl;
+
+    for (int arity : {0, 2, 4, 8}) {
+        auto sortOnce = [&](std::vector<Element>& work) {
+            if (arity == 0) {
+                std::make_heap(work.begin(), work.end());
+                std::sort_heap(work.begin(), work.end());
+            } else {
+                SortingEngine<Element, std::less<Element>, NoInstrumentation> engine;
+                engine.setHeapArity(arity);
+                engine.heapSort(work);
+            }
+        };
+
+        double best = 1e300;
+        HardwareCounters hw;
+        for (int r = 0; r < repetitions; r++) {
+            std::vector<Element> work = input;
+            perfCounters.start();
+            auto start = std::chrono::steady_clock::now();
+            sortOnce(work);
+            auto end = std::chrono::steady_clock::now();
+            HardwareCounters counters = perfCounters.stop();
+            double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+            if (elapsed < best) {
+                best = elapsed;
+                hw = counters;
+            }
+        }
+
+        // 比较次数单独计一次，不影响上面的计时
+        uint64_t comparisons = 0;
+        std::vector<Element> work = input;
+        if (arity == 0) {
+            auto counted = [&](const Element& a, const Element& b) { comparisons++; return a < b; };
+            std::make_heap(work.begin(), work.end(), counted);
+            std::sort_heap(work.begin(), work.end(), counted);
+        } else {
+            SortingEngine<Element> engine;
+            engine.setHeapArity(arity);
+            engine.heapSort(work);
+            comparisons = engine.getComparisons();
+        }
+
+        std::string name = arity == 0 ? "std::sort_heap" : std::to_string(arity) + " 叉堆";
+        out << std::left << std::setw(18) << name
+            << std::setw(14) << std::fixed << std::setprecision(3) << best
+            << std::setw(18) << std::setprecision(3) << comparisons / nLogN;
+        if (hw.has(HardwareCounter::LLCMisses)) {
+            out << std::setw(16) << std::setprecision(3)
+                << static_cast<double>(hw.get(HardwareCounter::LLCMisses)) / size;
+        } else {
+            out << std::setw(16) << "-";
+        }
+        out << std::endl;
+    }
+}
+
+} // namespace
+
+void runInstrumentationBenchmark(std::ostream& out, const std::vector<size_t>& sizes) {
+    const int repetitions = 5;
+    out << "\n======= 插桩开销基准测试（随机数据，取 " << repetitions << " 次最小值）=======\n" << std::endl;
+    out << std::left << std::setw(12) << "数据量"
+        << std::setw(15) << "算法"
+        << std::setw(14) << "不插桩(ms)"
+        << std::setw(14) << "计数(ms)"
+        << std::setw(14) << "std::sort(ms)"
+        << std::setw(10) << "ns/元素" << std::endl;
+    out << std::string(80, '-') << std::endl;
+
+    std::vector<std::pair<std::string, SortAlgorithm>> algorithms = {
+        {"Quick Sort", SortAlgorithm::QuickSort},
+        {"Intro Sort", SortAlgorithm::IntroSort},
+        {"PDQ Sort", SortAlgorithm::PdqSort},
+        {"Merge Sort", SortAlgorithm::MergeSort},
+        {"Power Sort", SortAlgorithm::PowerSort},
+        {"Heap Sort", SortAlgorithm::HeapSort},
+        {"LSD Radix Sort", SortAlgorithm::RadixSortLSD},
+        {"MSD Radix Sort", SortAlgorithm::RadixSortMSD}
+    };
+
+    for (size_t size : sizes) {
+        std::vector<int> input = SortingSystem::generateTestData(size, DataPattern::Random);
+
+        double baseline = 1e300;
+        for (int r = 0; r < repetitions; r++) {
+            std::vector<int> work = input;
+            auto start = std::chrono::steady_clock::now();
+            std::sort(work.begin(), work.end());
+            auto end = std::chrono::steady_clock::now();
+            baseline = std::min(baseline, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        for (const auto& alg : algorithms) {
+            double plain = timeEngineSort<NoInstrumentation>(alg.second, input, repetitions);
+            double counted = timeEngineSort<CountingInstrumentation>(alg.second, input, repetitions);
+            out << std::left << std::setw(12) << size
+                << std::setw(15) << alg.first
+                << std::setw(14) << std::fixed << std::setprecision(3) << plain
+                << std::setw(14) << counted
+                << std::setw(14) << baseline
+                << std::setw(10) << std::setprecision(2) << plain * 1e6 / size << std::endl;
+        }
+    }
+}
+
+void runParallelSpeedupBenchmark(std::ostream& out, size_t size) {
+    const int repetitions = 3;
+    std::vector<int> input = SortingSystem::generateTestData(size, DataPattern::Random);
+    std::vector<int> scratch(size);
+
+    auto bestOf = [&](auto&& sortOnce) {
+        double best = 1e300;
+        for (int r = 0; r < repetitions; r++) {
+            std::vector<int> work = input;
+            auto start = std::chrono::steady_clock::now();
+            sortOnce(work);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    };
+
+    double baseline = bestOf([&](std::vector<int>& work) {
+        SortingEngine<int, std::less<int>, NoInstrumentation> engine;
+        engine.mergeSort(work, scratch);
+    });
+
+    out << "\n======= 并行加速比测试（随机数据 " << size << " 个，基线为单线程 Merge Sort: "
+        << std::fixed << std::setprecision(3) << baseline << " ms）=======\n" << std::endl;
+    out << std::left << std::setw(8) << "线程数"
+        << std::setw(18) << "并行归并(ms)"
+        << std::setw(10) << "加速比"
+        << std::setw(18) << "并行快排(ms)"
+        << std::setw(10) << "加速比" << std::endl;
+    out << std::string(64, '-') << std::endl;
+
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; ; threads *= 2) {
+        threads = std::min(threads, maxThreads);
+        ThreadPool pool(threads);
+        ParallelSorter<int, std::less<int>, NoInstrumentation> sorter(pool);
+
+        double mergeTime = bestOf([&](std::vector<int>& work) { sorter.mergeSort(work, scratch); });
+        double quickTime = bestOf([&](std::vector<int>& work) { sorter.quickSort(work); });
+
+        out << std::left << std::setw(8) << threads
+            << std::setw(18) << std::setprecision(3) << mergeTime
+            << std::setw(10) << std::setprecision(2) << baseline / mergeTime
+            << std::setw(18) << std::setprecision(3) << quickTime
+            << std::setw(10) << std::setprecision(2) << baseline / quickTime << std::endl;
+
+        if (threads == maxThreads) break;
+    }
+}
+
+void runSortingNetworkBenchmark(std::ostream& out) {
+    const size_t totalElements = 1 << 20;
+    const int repetitions = 5;
+    SimdLevel detected = detectSimdLevel();
+    std::vector<int> input = SortingSystem::generateTestData(totalElements, DataPattern::Random);
+
+    auto bestOf = [&](auto&& sortOnce) {
+        double best = 1e300;
+        for (int r = 0; r < repetitions; r++) {
+            std::vector<int> work = input;
+            auto start = std::chrono::steady_clock::now();
+            sortOnce(work);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    };
+
+    out << "\n======= 排序网络基准测试（当前 CPU 支持: " << simdLevelName(detected) << "）=======\n" << std::endl;
+    out << std::left << std::setw(10) << "块大小"
+        << std::setw(14) << "插入排序"
+        << std::setw(14) << "Scalar"
+        << std::setw(14) << "SSE4.1"
+        << std::setw(14) << "AVX2"
+        << "(ns/元素)" << std::endl;
+    out << std::string(66, '-') << std::endl;
+
+    for (size_t block : {8u, 16u, 32u, 64u}) {
+        double insertion = bestOf([&](std::vector<int>& work) {
+            SortingEngine<int, std::less<int>, NoInstrumentation> engine;
+            for (size_t first = 0; first + block <= work.size(); first += block) {
+                engine.insertionSort(std::span<int>(work.data() + first, block));
+            }
+        });
+        out << std::left << std::setw(10) << block
+            << std::setw(14) << std::fixed << std::setprecision(2) << insertion * 1e6 / totalElements;
+
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2}) {
+            if (level > detected) {
+                out << std::setw(14) << "-";
+                continue;
+            }
+            setSimdLevel(level);
+            double network = bestOf([&](std::vector<int>& work) {
+                for (size_t first = 0; first + block <= work.size(); first += block) {
+                    sortingNetworkSort(work.data() + first, block);
+                }
+            });
+            out << std::setw(14) << network * 1e6 / totalElements;
+        }
+        out << std::endl;
+    }
+
+    out << "\n叶子排序对整体排序的影响（" << totalElements << " 个随机元素，ms）:" << std::endl;
+    out << std::left << std::setw(15) << "算法"
+        << std::setw(14) << "标量叶子"
+        << std::setw(14) << simdLevelName(detected) << std::endl;
+    out << std::string(43, '-') << std::endl;
+    std::vector<int> scratch(totalElements);
+    for (SortAlgorithm algorithm : {SortAlgorithm::QuickSort, SortAlgorithm::IntroSort, SortAlgorithm::PdqSort,
+                                    SortAlgorithm::MergeSort, SortAlgorithm::RadixSortMSD}) {
+        auto sortOnce = [&](std::vector<int>& work) {
+            SortingEngine<int, std::less<int>, NoInstrumentation> engine;
+            if (algorithm == SortAlgorithm::MergeSort) engine.mergeSort(work, scratch);
+            else engine.sort(algorithm, work);
+        };
+        setSimdLevel(SimdLevel::Scalar);
+        double scalar = bestOf(sortOnce);
+        setSimdLevel(detected);
+        double simd = bestOf(sortOnce);
+        out << std::left << std::setw(15) << sortAlgorithmName(algorithm)
+            << std::setw(14) << std::setprecision(3) << scalar
+            << std::setw(14) << simd << std::endl;
+    }
+    setSimdLevel(detected);
+}
+
+void runHeapArityBenchmark(std::ostream& out, const std::vector<size_t>& sizes) {
+    PerfCounterGroup perfCounters;
+    out << "\n======= 堆排序分叉数基准测试（当前默认 " << getDefaultHeapArity() << " 叉）=======" << std::endl;
+    if (!perfCounters.available()) {
+        out << "硬件计数器不可用，LLC 缺失一栏留空：" << perfCounters.unavailableReason() << std::endl;
+    }
+    for (size_t size : sizes) {
+        std::vector<int> keys = SortingSystem::generateTestData(size, DataPattern::Random);
+        runHeapArityBenchmark<int>(out, "int", keys, perfCounters);
+        runHeapArityBenchmark<SortRecord<16>>(out, "16 字节记录", keys, perfCounters);
+    }
+}
+
+void runExternalSort(std::ostream& out, const std::string& inputPath, const std::string& outputPath,
+                     size_t budgetMb) {
+    ThreadPool pool;
+    ExternalSortOptions options;
+    options.memoryBudget = std::max<size_t>(budgetMb, 1) << 20;
+    options.pool = &pool;
+    ExternalSorter sorter(options);
+
+    auto start = std::chrono::steady_clock::now();
+    sorter.sortFile(inputPath, outputPath);
+    double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const ExternalSortStats& stats = sorter.getStats();
+    out << "\n======= 外部排序（" << stats.elements << " 个键，段长 " << stats.runElements
+        << "，归并路数 " << stats.fanIn << "）=======\n" << std::endl;
+    out << std::left << std::setw(8) << "遍"
+        << std::setw(10) << "输入段"
+        << std::setw(10) << "输出段"
+        << std::setw(14) << "读取(MB)"
+        << std::setw(14) << "写入(MB)"
+        << std::setw(12) << "耗时(ms)" << std::endl;
+    out << std::string(68, '-') << std::endl;
+    for (const ExternalSortPass& pass : stats.passes) {
+        out << std::left << std::setw(8) << pass.pass
+            << std::setw(10) << pass.inputRuns
+            << std::setw(10) << pass.outputRuns
+            << std::setw(14) << std::fixed << std::setprecision(2) << pass.bytesRead / 1048576.0
+            << std::setw(14) << pass.bytesWritten / 1048576.0
+            << std::setw(12) << std::setprecision(3) << pass.timeTaken << std::endl;
+    }
+    out << "总读取: " << std::setprecision(2) << stats.totalBytesRead() / 1048576.0 << " MB，总写入: "
+        << stats.totalBytesWritten() / 1048576.0 << " MB，总耗时: " << std::setprecision(3) << total << " ms" << std::endl;
+    out << "排序结果验证: " << (ExternalSorter::isKeyFileSorted(outputPath) ? "正确" : "错误") << std::endl;
+}
+
+void runMappedDatasetSort(std::ostream& out, const std::string& path, SortAlgorithm algorithm,
+                          const std::string& outputPath) {
+    auto start = std::chrono::steady_clock::now();
+    MappedDataset dataset(path);
+    double mapTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    out << "已映射 " << dataset.size() << " 个 " << datasetElementTypeName(dataset.elementType())
+        << " 元素（含校验 " << std::fixed << std::setprecision(3) << mapTime << " ms）。" << std::endl;
+
+    visitDatasetElements(dataset, [&](auto values) {
+        using T = typename decltype(values)::element_type;
+        ThreadPool pool;
+        start = std::chrono::steady_clock::now();
+        dispatchSort<T, std::less<T>, NoInstrumentation>(algorithm, values, {}, &pool);
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        out << sortAlgorithmName(algorithm) << " 耗时: " << std::fixed << std::setprecision(3) << elapsed << " ms（"
+            << std::setprecision(2) << elapsed * 1e6 / std::max<size_t>(values.size(), 1) << " ns/元素）" << std::endl;
+        out << "排序结果验证: " << (std::is_sorted(values.begin(), values.end()) ? "正确" : "错误") << std::endl;
+        if (!outputPath.empty()) {
+            writeDataset<T>(outputPath, values);
+            out << "已保存到 " << outputPath << "。" << std::endl;
+        }
+    });
+}
@@ -0,0 +1,33 @@
+#ifndef SORT_BENCHMARKS_H
+#define SORT_BENCHMARKS_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "sorting_engine.h"
+
+// 排序引擎的专项基准测试：结果以表格写到 out，交互菜单与命令行的 --experiment 共用。
+// 数据均为随机生成；参数只决定规模，不读取标准输入。
+
+// 比较同一算法在不插桩/计数两种策略下的吞吐，并以 std::sort 作为基线
+void runInstrumentationBenchmark(std::ostream& out, const std::vector<size_t>& sizes);
+
+// 并行归并/快速排序在不同线程数下相对单线程 mergeSort 的加速比
+void runParallelSpeedupBenchmark(std::ostream& out, size_t size);
+
+// 小块排序：插入排序与各指令集排序网络的单元素耗时，以及作为叶子排序时整体排序的耗时
+void runSortingNetworkBenchmark(std::ostream& out);
+
+// 堆排序：std::make_heap + std::sort_heap 与 2/4/8 叉堆在 int 和 16 字节记录上的耗时、比较次数与 LLC 缺失
+void runHeapArityBenchmark(std::ostream& out, const std::vector<size_t>& sizes);
+
+// 外部排序：文件可以远大于内存，按内存预算（MB）分段排序后多路归并，输出每一遍的读写量与耗时
+void runExternalSort(std::ostream& out, const std::string& inputPath, const std::string& outputPath,
+                     size_t budgetMb);
+
+// 直接在内存映射上原地排序，不拷贝到 SortingSystem；不插桩，只计时。outputPath 非空时保存排序结果
+void runMappedDatasetSort(std::ostream& out, const std::string& path, SortAlgorithm algorithm,
+                          const std::string& outputPath);
+
+#endif // SORT_BENCHMARKS_H
@@ -0,0 +1,70 @@
+#ifndef SORT_INSTRUMENTATION_H
+#define SORT_INSTRUMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 排序引擎的插桩策略（编译期选择）
+// 引擎在每次比较/交换/移动/写入时调用策略的钩子：
+//   compare(i, j)  比较 data[i] 与 data[j]（-1 表示参与比较的是暂存值，如枢轴或缓冲区元素）
+//   swap(i, j)     交换 data[i] 与 data[j]
+//   move(dst, src) 数组内元素搬移（插入排序的右移）
+//   write(k, v)    将暂存值 v 写回 data[k]
+//   allocate(b)    排序过程中申请了 b 字节的堆内存
+// NoInstrumentation 的钩子全部为空，内联后不产生任何指令，用于纯计时。
+
+// 不插桩：零开销
+struct NoInstrumentation {
+    static constexpr bool enabled = false;
+
+    void reset() {}
+    void compare(std::ptrdiff_t, std::ptrdiff_t) {}
+    void swap(std::ptrdiff_t, std::ptrdiff_t) {}
+    void move(std::ptrdiff_t, std::ptrdiff_t) {}
+    template <typename V>
+    void write(std::ptrdiff_t, const V&) {}
+    void allocate(size_t) {}
+
+    size_t comparisons() const { return 0; }
+    size_t swaps() const { return 0; }
+    size_t allocations() const { return 0; }
+    size_t allocatedBytes() const { return 0; }
+};
+
+// 计数：与原 SortingSystem 的统计口径一致（插入排序的移动计入交换次数）
+struct CountingInstrumentation {
+    static constexpr bool enabled = true;
+
+    size_t comparisonCount = 0;
+    size_t swapCount = 0;
+    size_t allocationCount = 0;
+    size_t allocatedByteCount = 0;
+
+    void reset() {
+        comparisonCount = 0;
+        swapCount = 0;
+        allocationCount = 0;
+        allocatedByteCount = 0;
+    }
+    void compare(std::ptrdiff_t, std::ptrdiff_t) { comparisonCount++; }
+    void swap(std::ptrdiff_t, std::ptrdiff_t) { swapCount++; }
+    void move(std::ptrdiff_t, std::ptrdiff_t) { swapCount++; }
+    template <typename V>
+    void write(std::ptrdiff_t, const V&) {}
+    void allocate(size_t bytes) {
+        allocationCount++;
+        allocatedByteCount += bytes;
+    }
+
+    size_t comparisons() const { return comparisonCount; }
+    size_t swaps() const { return swapCount; }
+    size_t allocations() const { return allocationCount; }
+    size_t allocatedBytes() const { return allocatedByteCount; }
+};
+
+// 排序事件的种类，与上面的钩子一一对应（事件记录与回放见 sort_trace.h 的 TraceRecorder/TraceEvent）
+struct SortEvent {
+    enum class Type : uint8_t { Compare, Swap, Move, Write };
+};
+
+#endif // SORT_INSTRUMENTATION_H
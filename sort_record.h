@@ -0,0 +1,118 @@
+#ifndef SORT_RECORD_H
+#define SORT_RECORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 带原始下标的排序记录：只按 key 比较，index 为排序前的位置。
+// 排序后检查相等键的 index 是否递增即可实测稳定性（在纯 int 上稳定与否无法观察）。
+// Bytes 为整条记录的大小（8 = 仅键和下标，16/64 附带载荷），用于衡量搬移更宽元素的代价；
+// 载荷由下标导出，排序后据此检查记录在搬移中是否保持完整。
+template <size_t Bytes>
+struct SortRecord {
+    static_assert(Bytes >= 8 && Bytes % 4 == 0, "record must hold a 32-bit key and index");
+    static constexpr size_t kPayloadWords = (Bytes - 8) / 4;
+
+    int32_t key;
+    uint32_t index;
+    uint32_t payload[kPayloadWords];
+
+    SortRecord() = default;
+    SortRecord(int32_t key, uint32_t index) : key(key), index(index) {
+        for (size_t w = 0; w < kPayloadWords; w++) payload[w] = payloadWord(index, w);
+    }
+
+    int32_t sortKey() const { return key; }
+    bool operator<(const SortRecord& other) const { return key < other.key; }
+
+    bool payloadIntact() const {
+        for (size_t w = 0; w < kPayloadWords; w++) {
+            if (payload[w] != payloadWord(index, w)) return false;
+        }
+        return true;
+    }
+
+    static uint32_t payloadWord(uint32_t index, size_t w) {
+        return index * 0x9E3779B1u + static_cast<uint32_t>(w);
+    }
+};
+
+// 仅键和下标的记录不带载荷
+template <>
+struct SortRecord<8> {
+    static constexpr size_t kPayloadWords = 0;
+
+    int32_t key;
+    uint32_t index;
+
+    SortRecord() = default;
+    SortRecord(int32_t key, uint32_t index) : key(key), index(index) {}
+
+    int32_t sortKey() const { return key; }
+    bool operator<(const SortRecord& other) const { return key < other.key; }
+    bool payloadIntact() const { return true; }
+};
+
+static_assert(sizeof(SortRecord<8>) == 8 && sizeof(SortRecord<16>) == 16 && sizeof(SortRecord<64>) == 64);
+
+// 以 keys 为键、原始位置为下标构造记录
+template <typename Record>
+std::vector<Record> makeSortRecords(std::span<const int> keys) {
+    std::vector<Record> records;
+    records.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) records.emplace_back(keys[i], static_cast<uint32_t>(i));
+    return records;
+}
+
+// 排序结果检查
+struct RecordOrderCheck {
+    bool sorted = true; // 键不降
+    bool stable = true; // 相等键的原始下标递增
+    bool intact = true; // 恰为原记录的一个排列，且载荷未损坏
+};
+
+template <typename Record>
+RecordOrderCheck checkRecordOrder(std::span<const Record> records) {
+    RecordOrderCheck check;
+    std::vector<bool> seen(records.size(), false);
+    for (size_t i = 0; i < records.size(); i++) {
+        const Record& record = records[i];
+        if (record.index >= records.size() || seen[record.index] || !record.payloadIntact()) {
+            check.intact = false;
+        } else {
+            seen[record.index] = true;
+        }
+        if (i == 0) continue;
+        const Record& previous = records[i - 1];
+        if (record.key < previous.key) check.sorted = false;
+        else if (record.key == previous.key && record.index < previous.index) check.stable = false;
+    }
+    return check;
+}
+
+// 稳定性探测的输入：键在 [0, distinctKeys) 内伪随机取值，每个键重复多次
+template <typename Record>
+std::vector<Record> makeStabilityProbe(size_t size, uint32_t distinctKeys = 16) {
+    std::vector<Record> records;
+    records.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        uint64_t h = (static_cast<uint64_t>(i) + 1) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 31)) * 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        records.emplace_back(static_cast<int32_t>(h % distinctKeys), static_cast<uint32_t>(i));
+    }
+    return records;
+}
+
+// 实测稳定性：sortRecords 对探测数据排序后，结果有序且相等键保持原有顺序才算稳定
+template <typename Record, typename SortFn>
+bool probeStability(size_t size, SortFn&& sortRecords) {
+    std::vector<Record> records = makeStabilityProbe<Record>(size);
+    sortRecords(std::span<Record>(records));
+    RecordOrderCheck check = checkRecordOrder<Record>(records);
+    return check.sorted && check.intact && check.stable;
+}
+
+#endif // SORT_RECORD_H
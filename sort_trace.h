@@ -0,0 +1,255 @@
+#ifndef SORT_TRACE_H
+#define SORT_TRACE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "sort_instrumentation.h"
+#include "sorting_engine.h"
+
+// 与平台无关的排序事件追踪：算法在 SortingEngine 中全速运行，钩子把比较/交换/移动/写入
+// 追加到紧凑的事件缓冲区；前端之后按自己的帧率用 TraceReplayer 回放，算法本身不再与
+// 绘制、休眠、加锁交织。
+
+// 紧凑事件：16 字节，下标按 uint32 记录（暂存值为 kTraceTempIndex），值按 int32 记录
+struct TraceEvent {
+    SortEvent::Type type;
+    uint32_t first;  // Compare/Swap 的第一个下标，Move/Write 的目标
+    uint32_t second; // Compare/Swap 的第二个下标，Move 的来源，Write 时不用
+    int32_t value;   // Write 写入的值（按 int32 记录）
+};
+static_assert(sizeof(TraceEvent) == 16);
+
+// 比较中参与的暂存值（引擎中的下标 -1）
+inline constexpr uint32_t kTraceTempIndex = std::numeric_limits<uint32_t>::max();
+
+// 分块事件缓冲区：每块 kChunkEvents 个事件，块在追加时按需申请，clear() 后保留复用，
+// 已记录的事件地址在缓冲区存活期间不变。reserve() 预先申请全部块，记录过程中不再分配；
+// limit 限制最多保存的事件数，超出部分只计数不保存（truncated() 为 true）
+class TraceBuffer {
+public:
+    static constexpr size_t kChunkShift = 16;
+    static constexpr size_t kChunkEvents = size_t(1) << kChunkShift;
+
+    explicit TraceBuffer(size_t limit = std::numeric_limits<size_t>::max()) : limit(limit) {}
+
+    TraceBuffer(TraceBuffer&& other) noexcept { *this = std::move(other); }
+    TraceBuffer& operator=(TraceBuffer&& other) noexcept {
+        chunks = std::move(other.chunks);
+        activeChunk = std::exchange(other.activeChunk, 0);
+        cursor = std::exchange(other.cursor, nullptr);
+        chunkEnd = std::exchange(other.chunkEnd, nullptr);
+        limit = other.limit;
+        droppedCount = std::exchange(other.droppedCount, 0);
+        other.chunks.clear();
+        return *this;
+    }
+
+    void push(const TraceEvent& event) {
+        if (cursor == chunkEnd) [[unlikely]] {
+            if (!advance()) {
+                droppedCount++;
+                return;
+            }
+        }
+        *cursor++ = event;
+    }
+
+    // 清空事件，保留已申请的块
+    void clear() {
+        activeChunk = 0;
+        cursor = chunkEnd = nullptr;
+        droppedCount = 0;
+    }
+
+    void setLimit(size_t events) {
+        limit = events;
+        clear();
+    }
+    size_t getLimit() const { return limit; }
+
+    // 预先申请能容纳 events 个事件的块（不超过 limit）
+    void reserve(size_t events) {
+        events = std::min(events, limit);
+        while (chunks.size() * kChunkEvents < events) {
+            chunks.push_back(std::make_unique<TraceEvent[]>(kChunkEvents));
+        }
+    }
+
+    size_t size() const {
+        if (cursor == nullptr) return 0;
+        return activeChunk * kChunkEvents + static_cast<size_t>(cursor - chunks[activeChunk].get());
+    }
+    bool empty() const { return size() == 0; }
+    size_t dropped() const { return droppedCount; }
+    bool truncated() const { return droppedCount > 0; }
+    size_t allocatedBytes() const { return chunks.size() * kChunkEvents * sizeof(TraceEvent); }
+
+    const TraceEvent& operator[](size_t i) const { return chunks[i >> kChunkShift][i & (kChunkEvents - 1)]; }
+
+    // 按块顺序访问，顺序遍历时省去逐个事件的分块寻址
+    size_t chunkCount() const { return cursor == nullptr ? 0 : activeChunk + 1; }
+    std::span<const TraceEvent> chunk(size_t c) const {
+        size_t begin = c * kChunkEvents;
+        return {chunks[c].get(), std::min(kChunkEvents, size() - begin)};
+    }
+
+private:
+    std::vector<std::unique_ptr<TraceEvent[]>> chunks;
+    size_t activeChunk = 0;
+    TraceEvent* cursor = nullptr;
+    TraceEvent* chunkEnd = nullptr;
+    size_t limit;
+    size_t droppedCount = 0;
+
+    // 当前块写满时换到下一块（按需申请）；下一块超出 limit 时返回 false。
+    // 最后一块可写入的事件数同样受 limit 约束
+    bool advance() {
+        size_t next = cursor == nullptr ? 0 : activeChunk + 1;
+        if (next * kChunkEvents >= limit) return false;
+        if (next == chunks.size()) chunks.push_back(std::make_unique<TraceEvent[]>(kChunkEvents));
+        activeChunk = next;
+        cursor = chunks[next].get();
+        chunkEnd = cursor + std::min(kChunkEvents, limit - next * kChunkEvents);
+        return true;
+    }
+};
+
+// 插桩策略：在计数的基础上把事件写入 TraceBuffer
+struct TraceRecorder : CountingInstrumentation {
+    TraceBuffer events;
+
+    void reset() {
+        CountingInstrumentation::reset();
+        events.clear();
+    }
+    void compare(std::ptrdiff_t i, std::ptrdiff_t j) {
+        CountingInstrumentation::compare(i, j);
+        events.push({SortEvent::Type::Compare, traceIndex(i), traceIndex(j), 0});
+    }
+    void swap(std::ptrdiff_t i, std::ptrdiff_t j) {
+        CountingInstrumentation::swap(i, j);
+        events.push({SortEvent::Type::Swap, traceIndex(i), traceIndex(j), 0});
+    }
+    void move(std::ptrdiff_t dst, std::ptrdiff_t src) {
+        CountingInstrumentation::move(dst, src);
+        events.push({SortEvent::Type::Move, traceIndex(dst), traceIndex(src), 0});
+    }
+    template <typename V>
+    void write(std::ptrdiff_t k, const V& v) {
+        int32_t value = 0;
+        if constexpr (std::is_arithmetic_v<V>) value = static_cast<int32_t>(v);
+        events.push({SortEvent::Type::Write, traceIndex(k), kTraceTempIndex, value});
+    }
+
+    static uint32_t traceIndex(std::ptrdiff_t i) { return i < 0 ? kTraceTempIndex : static_cast<uint32_t>(i); }
+};
+
+// 一次排序的完整记录：初始数组 + 事件序列，回放到末尾即得到排序结果
+struct SortTrace {
+    SortAlgorithm algorithm = SortAlgorithm::BubbleSort;
+    std::vector<int> initial;
+    TraceBuffer events;
+    size_t comparisons = 0;
+    size_t swaps = 0;
+    double recordMs = 0.0; // 含记录开销的排序耗时
+};
+
+// 按事件回放：values() 为已应用前 position() 个事件后的数组；trace 须在回放期间保持有效
+class TraceReplayer {
+public:
+    explicit TraceReplayer(const SortTrace& trace) : trace(trace), current(trace.initial) {}
+
+    bool done() const { return cursor >= trace.events.size(); }
+    size_t position() const { return cursor; }
+    size_t size() const { return trace.events.size(); }
+    std::span<const int> values() const { return current; }
+
+    // 应用下一个事件并返回它（调用前需确认 !done()）
+    const TraceEvent& step() {
+        const TraceEvent& event = trace.events[cursor++];
+        apply(event);
+        return event;
+    }
+
+    // 最多应用 count 个事件，返回实际应用的个数
+    size_t advance(size_t count) {
+        size_t end = std::min(trace.events.size(), cursor + count);
+        size_t applied = end - cursor;
+        while (cursor < end) apply(trace.events[cursor++]);
+        return applied;
+    }
+
+    void rewind() {
+        current = trace.initial;
+        cursor = 0;
+    }
+
+    // 跳到第 target 个事件之后；向后跳时从头重放
+    void seek(size_t target) {
+        if (target < cursor) rewind();
+        advance(target - cursor);
+    }
+
+private:
+    const SortTrace& trace;
+    std::vector<int> current;
+    size_t cursor = 0;
+
+    void apply(const TraceEvent& event) {
+        switch (event.type) {
+            case SortEvent::Type::Compare: break;
+            case SortEvent::Type::Swap: std::swap(current[event.first], current[event.second]); break;
+            case SortEvent::Type::Move: current[event.first] = current[event.second]; break;
+            case SortEvent::Type::Write: current[event.first] = event.value; break;
+        }
+    }
+};
+
+// 以全速运行 algorithm 并记录事件。基数排序不经过引擎的比较/交换钩子，
+// 排序后对与回放结果不同的位置补记 Write 事件，使回放总能得到排序结果。
+// limit 限制保存的事件数（超出后 trace.events.truncated() 为 true，回放停在中途）。
+// 并行算法的事件顺序取决于线程调度，无法回放，抛出 std::invalid_argument
+inline SortTrace recordSortTrace(SortAlgorithm algorithm, std::span<const int> input,
+                                 size_t limit = std::numeric_limits<size_t>::max()) {
+    if (isParallelSortAlgorithm(algorithm)) {
+        throw std::invalid_argument(std::string(sortAlgorithmName(algorithm)) + " 不支持记录事件");
+    }
+    SortTrace trace;
+    trace.algorithm = algorithm;
+    trace.initial.assign(input.begin(), input.end());
+
+    std::vector<int> work = trace.initial;
+    SortingEngine<int, std::less<int>, TraceRecorder> engine;
+    engine.getInstrumentation().events.setLimit(limit);
+    auto start = std::chrono::steady_clock::now();
+    engine.sort(algorithm, work);
+    auto end = std::chrono::steady_clock::now();
+
+    trace.recordMs = std::chrono::duration<double, std::milli>(end - start).count();
+    trace.comparisons = engine.getComparisons();
+    trace.swaps = engine.getSwaps();
+    trace.events = std::move(engine.getInstrumentation().events);
+
+    if (!trace.events.truncated()) {
+        TraceReplayer replayer(trace);
+        replayer.advance(trace.events.size());
+        std::span<const int> replayed = replayer.values();
+        for (size_t i = 0; i < work.size(); i++) {
+            if (replayed[i] != work[i]) {
+                trace.events.push({SortEvent::Type::Write, static_cast<uint32_t>(i), kTraceTempIndex, work[i]});
+            }
+        }
+    }
+    return trace;
+}
+
+#endif // SORT_TRACE_H
@@ -0,0 +1,1449 @@
+#ifndef SORTING_ENGINE_H
+#define SORTING_ENGINE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <utility>
+#include "sort_instrumentation.h"
+#include "radix_sort.h"
+#include "sorting_network.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// 排序算法枚举（替代 void (SortingSystem::*)() 成员函数指针分发）
+enum class SortAlgorithm {
+    BubbleSort,
+    QuickSort,
+    MergeSort,
+    HeapSort,
+    InsertionSort,
+    SelectionSort,
+    IntroSort,
+    PdqSort,
+    ParallelMergeSort,
+    ParallelQuickSort,
+    RadixSortLSD,
+    RadixSortMSD,
+    PowerSort
+};
+
+// 已注册的算法列表（性能比较表按此顺序输出）
+inline constexpr std::array<SortAlgorithm, 13> kAllSortAlgorithms = {
+    SortAlgorithm::BubbleSort,
+    SortAlgorithm::InsertionSort,
+    SortAlgorithm::SelectionSort,
+    SortAlgorithm::QuickSort,
+    SortAlgorithm::MergeSort,
+    SortAlgorithm::PowerSort,
+    SortAlgorithm::HeapSort,
+    SortAlgorithm::IntroSort,
+    SortAlgorithm::PdqSort,
+    SortAlgorithm::ParallelMergeSort,
+    SortAlgorithm::ParallelQuickSort,
+    SortAlgorithm::RadixSortLSD,
+    SortAlgorithm::RadixSortMSD
+};
+
+// 算法名称（用于报表输出）
+inline const char* sortAlgorithmName(SortAlgorithm algorithm) {
+    switch (algorithm) {
+        case SortAlgorithm::BubbleSort:    return "Bubble Sort";
+        case SortAlgorithm::QuickSort:     return "Quick Sort";
+        case SortAlgorithm::MergeSort:     return "Merge Sort";
+        case SortAlgorithm::HeapSort:      return "Heap Sort";
+        case SortAlgorithm::InsertionSort: return "Insertion Sort";
+        case SortAlgorithm::SelectionSort: return "Selection Sort";
+        case SortAlgorithm::IntroSort:     return "Intro Sort";
+        case SortAlgorithm::PdqSort:       return "PDQ Sort";
+        case SortAlgorithm::ParallelMergeSort: return "Parallel Merge Sort";
+        case SortAlgorithm::ParallelQuickSort: return "Parallel Quick Sort";
+        case SortAlgorithm::RadixSortLSD:  return "LSD Radix Sort";
+        case SortAlgorithm::RadixSortMSD:  return "MSD Radix Sort";
+        case SortAlgorithm::PowerSort:     return "Power Sort";
+    }
+    return "Unknown";
+}
+
+// 并行算法需要线程池，只能经由 dispatchSort（parallel_sort.h）执行
+inline constexpr bool isParallelSortAlgorithm(SortAlgorithm algorithm) {
+    return algorithm == SortAlgorithm::ParallelMergeSort || algorithm == SortAlgorithm::ParallelQuickSort;
+}
+
+inline constexpr bool isRadixSortAlgorithm(SortAlgorithm algorithm) {
+    return algorithm == SortAlgorithm::RadixSortLSD || algorithm == SortAlgorithm::RadixSortMSD;
+}
+
+// 选择算法：只需要最小的 k 个元素或第 k 小的元素时，不必完整排序
+enum class SelectionAlgorithm {
+    PartialSort, // 前 k 个位置为最小的 k 个元素且升序
+    NthElement,  // 第 k 小的元素就位，两侧已按它分开
+    TopKStream   // 流式 top-k：只保留 k 个元素的有界堆（TopKSelector）
+};
+
+inline constexpr std::array<SelectionAlgorithm, 3> kAllSelectionAlgorithms = {
+    SelectionAlgorithm::PartialSort,
+    SelectionAlgorithm::NthElement,
+    SelectionAlgorithm::TopKStream
+};
+
+inline const char* selectionAlgorithmName(SelectionAlgorithm algorithm) {
+    switch (algorithm) {
+        case SelectionAlgorithm::PartialSort: return "Partial Sort";
+        case SelectionAlgorithm::NthElement:  return "Nth Element";
+        case SelectionAlgorithm::TopKStream:  return "Top-K Stream";
+    }
+    return "Unknown";
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+class TopKSelector;
+
+// 堆排序的分叉数：2（二叉堆）、4 或 8。多叉堆层数更少，每层的孩子在内存中连续，
+// 同一组孩子落在一个缓存行内，n 很大时缓存缺失明显减少
+inline constexpr int kHeapArities[] = {2, 4, 8};
+inline constexpr size_t kCacheLineSize = 64;
+
+inline bool isSupportedHeapArity(int arity) {
+    return arity == 2 || arity == 4 || arity == 8;
+}
+
+// 新建引擎默认使用的分叉数（进程级设置，与 setSimdLevel 类似，用于对比测试）
+inline std::atomic<int>& defaultHeapArityStorage() {
+    static std::atomic<int> arity{4};
+    return arity;
+}
+inline int getDefaultHeapArity() { return defaultHeapArityStorage().load(std::memory_order_relaxed); }
+inline void setDefaultHeapArity(int arity) {
+    if (isSupportedHeapArity(arity)) defaultHeapArityStorage().store(arity, std::memory_order_relaxed);
+}
+
+// 软件预取（只读，保留在各级缓存）；不支持的编译器上为空操作
+inline void prefetchRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+// 类型泛型排序引擎
+// 元素类型 T 与比较器 Compare 在编译期确定，比较器调用可被编译器内联。
+// 引擎不持有数据，只对传入的 std::span 原地排序。
+// Instrumentation 为插桩策略（见 sort_instrumentation.h）：
+//   NoInstrumentation 用于纯计时，CountingInstrumentation 统计比较/交换次数，
+//   TraceRecorder / TraceFileRecorder（sort_trace.h、trace_file.h）额外记录事件序列。
+template <typename T, typename Compare = std::less<T>, typename Instrumentation = CountingInstrumentation>
+class SortingEngine {
+public:
+    using Index = std::ptrdiff_t;
+
+    explicit SortingEngine(Compare comp = Compare()) : comp(comp) {}
+
+    // 按枚举分发到顺序算法，归并排序、powersort 与 LSD 基数排序使用 scratch 作缓冲区（不足时自行申请）。
+    // 不做任何替换：并行算法需要线程池，请用 dispatchSort（parallel_sort.h）；
+    // 基数排序只适用于整数/浮点键的默认升序，且不经过插桩钩子（统计见 getRadixStats）。
+    // 不能执行时抛出 std::invalid_argument
+    void sort(SortAlgorithm algorithm, std::span<T> range, std::span<T> scratch = {}) {
+        switch (algorithm) {
+            case SortAlgorithm::BubbleSort:    bubbleSort(range); break;
+            case SortAlgorithm::QuickSort:     quickSort(range); break;
+            case SortAlgorithm::MergeSort:     mergeSort(range, scratch); break;
+            case SortAlgorithm::HeapSort:      heapSort(range); break;
+            case SortAlgorithm::InsertionSort: insertionSort(range); break;
+            case SortAlgorithm::SelectionSort: selectionSort(range); break;
+            case SortAlgorithm::IntroSort:     introSort(range); break;
+            case SortAlgorithm::PdqSort:       pdqSort(range); break;
+            case SortAlgorithm::PowerSort:     powerSort(range, scratch); break;
+            case SortAlgorithm::ParallelMergeSort:
+            case SortAlgorithm::ParallelQuickSort:
+                throw std::invalid_argument(std::string(sortAlgorithmName(algorithm)) + " 需要线程池（见 dispatchSort）");
+            case SortAlgorithm::RadixSortLSD:
+            case SortAlgorithm::RadixSortMSD:
+                if constexpr (kRadixSortable) {
+                    resetCounters();
+                    RadixSorter<T> sorter;
+                    if (algorithm == SortAlgorithm::RadixSortLSD) sorter.lsdSort(range, scratch);
+                    else sorter.msdSort(range);
+                    radixStats = sorter.getStats();
+                } else {
+                    throw std::invalid_argument(std::string(sortAlgorithmName(algorithm)) +
+                                                " 只支持整数/浮点键的默认升序排序");
+                }
+                break;
+        }
+    }
+
+    // 排序算法实现
+    void bubbleSort(std::span<T> range);
+    void quickSort(std::span<T> range);
+    // 自底向上归并排序：只使用一块 n 大小的缓冲区，在原数组与缓冲区之间来回归并；
+    // scratch 由调用方提供（大小不小于 n）时排序过程不申请任何内存
+    void mergeSort(std::span<T> range, std::span<T> scratch = {});
+    // 自然归并排序（powersort，稳定）：识别天然升序段与严格降序段（后者原地翻转），
+    // 短段用二分插入排序补足到 minRun，按 powersort 的节点幂次规则决定归并顺序，归并时使用
+    // TimSort 式 galloping。已有序或由少数有序段组成的数据只需 O(n) 次比较且不申请内存；
+    // 缓冲区在第一次归并时才申请（最多 n/2 个元素），scratch 足够大时不申请
+    void powerSort(std::span<T> range, std::span<T> scratch = {});
+    // 堆排序：迭代式 Floyd 自底向上下沉（沿较大的孩子直接下到叶子，再把元素上浮到位），
+    // 二叉堆每层只需 1 次比较；分叉数见 setHeapArity，下沉时预取孙子节点所在的缓存行
+    void heapSort(std::span<T> range);
+    // 不支持的分叉数被忽略；内省排序与 pdqsort 退化时的堆排序同样使用该设置
+    void setHeapArity(int arity) {
+        if (isSupportedHeapArity(arity)) heapArity = arity;
+    }
+    int getHeapArity() const { return heapArity; }
+    void insertionSort(std::span<T> range);
+    void selectionSort(std::span<T> range);
+    // 内省排序：九数取中枢轴 + 小区间插入排序 + 深度超过 2·log2(n) 时退化为堆排序
+    void introSort(std::span<T> range);
+
+    // 模式消除快速排序（pdqsort）：已有序/已分区的区间在线性时间内结束，
+    // 算术类型配合默认比较器时使用 BlockQuicksort 式无分支分区
+    void pdqSort(std::span<T> range);
+
+    // 部分排序：前 k 个位置为整个区间最小的 k 个元素且升序，其余元素顺序未定。
+    // 前 k 个元素建大顶堆，其余元素小于堆顶时替换堆顶，最后对堆做堆排序，O(n log k)；
+    // k 超过 n / kPartialSortHeapDivisor 时改为 nthElement 后对前 k 个做 pdqSort
+    void partialSort(std::span<T> range, size_t k);
+    // 第 k 小（从 0 计）的元素放到 range[k]，左侧不大于它、右侧不小于它。
+    // introselect：九数取中 + Hoare 分区，只继续处理包含 k 的一侧；分区超过 2·log2(n) 次
+    // 仍未收敛时改用 median-of-medians 选枢轴，最坏情况 O(n)
+    void nthElement(std::span<T> range, size_t k);
+
+    // 叶子排序使用 SIMD 排序网络的条件：int32/int64/float 的默认升序，且不插桩
+    // （排序网络不经过比较/交换钩子，计数和追踪需要逐次操作的版本）
+    static constexpr bool kSortingNetworkLeaf =
+        SortingNetworkSortable<T> && std::is_same_v<Compare, std::less<T>> && !Instrumentation::enabled;
+
+    // 归并排序初始有序段长度（先用插入排序或排序网络生成）
+    static constexpr Index kMergeSortRunLength = 16;
+
+    // powersort 参数：天然有序段短于 minRun（32~64，见 powerSortMinRun）时补足；
+    // 连续 kMinGallop 次从同一侧取元素后进入 galloping 模式
+    static constexpr Index kMinGallop = 7;
+    static constexpr size_t kMaxPendingRuns = 65;
+
+    static constexpr Index kPartialSortHeapDivisor = 8;
+
+    // 内省排序参数
+    static constexpr Index kInsertionSortCutoff = 16;
+    static constexpr Index kNintherThreshold = 128;
+
+    // pdqsort 参数
+    static constexpr Index kPdqInsertionSortThreshold = 24;
+    static constexpr Index kPartialInsertionSortLimit = 8;
+    static constexpr Index kPartitionBlockSize = 64;
+    static constexpr bool kRadixSortable = RadixSortable<T> && std::is_same_v<Compare, std::less<T>>;
+    static constexpr bool kBranchlessPartition =
+        std::is_arithmetic_v<T> &&
+        (std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::greater<T>> ||
+         std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::greater<>>);
+
+    // 性能统计
+    void resetCounters() {
+        instrumentation.reset();
+        radixStats = RadixSortStats();
+    }
+    size_t getComparisons() const { return instrumentation.comparisons(); }
+    size_t getSwaps() const { return instrumentation.swaps(); }
+    size_t getAllocations() const { return instrumentation.allocations() + radixStats.allocations; }
+    // 最近一次基数排序的遍数与搬移字节数（基数排序不做比较，以此代替比较/交换次数）
+    const RadixSortStats& getRadixStats() const { return radixStats; }
+    Instrumentation& getInstrumentation() { return instrumentation; }
+    const Instrumentation& getInstrumentation() const { return instrumentation; }
+
+    bool isSorted(std::span<const T> range) const {
+        for (size_t i = 1; i < range.size(); i++) {
+            if (comp(range[i], range[i - 1])) return false;
+        }
+        return true;
+    }
+
+private:
+    // 流式 top-k 把堆放在自己的缓冲区里，直接复用引擎的比较/交换钩子与 heapify
+    friend class TopKSelector<T, Compare, Instrumentation>;
+
+    [[no_unique_address]] Compare comp;
+    [[no_unique_address]] Instrumentation instrumentation;
+    RadixSortStats radixStats;
+    T* data = nullptr;
+    int heapArity = getDefaultHeapArity();
+
+    void bind(std::span<T> range) {
+        resetCounters();
+        data = range.data();
+    }
+
+    // 带插桩的比较：a < b，ia/ib 为参与比较元素在数组中的位置（-1 表示暂存值）
+    bool less(const T& a, const T& b, Index ia, Index ib) {
+        instrumentation.compare(ia, ib);
+        return comp(a, b);
+    }
+
+    bool lessAt(Index i, Index j) {
+        return less(data[i], data[j], i, j);
+    }
+
+    void swap(Index i, Index j) {
+        if (i != j) {
+            using std::swap;
+            swap(data[i], data[j]);
+            instrumentation.swap(i, j);
+        }
+    }
+
+    void moveElement(Index dst, Index src) {
+        data[dst] = std::move(data[src]);
+        instrumentation.move(dst, src);
+    }
+
+    void write(Index k, T&& value) {
+        data[k] = std::move(value);
+        instrumentation.write(k, data[k]);
+    }
+
+    // 排序算法辅助函数
+    void quickSortHelper(Index low, Index high);
+    Index partition(Index low, Index high);
+    void mergeRuns(T* src, T* dst, Index left, Index mid, Index right);
+
+    // powersort 辅助
+    struct PowerSortState {
+        std::span<T> buffer;
+        std::vector<T> ownBuffer;
+        size_t bufferCapacity = 0; // 需要申请时一次申请 n/2，之后所有归并复用
+        Index minGallop = kMinGallop;
+    };
+    static Index powerSortMinRun(Index n);
+    static int powerSortNodePower(Index start1, Index length1, Index length2, Index n);
+    Index countRunAndMakeAscending(Index first, Index last);
+    void binaryInsertionSort(Index first, Index last, Index sortedEnd);
+    template <typename Pred>
+    static Index gallopSearch(Pred pred, Index length, Index hint);
+    void mergeNaturalRuns(PowerSortState& state, Index base1, Index length1, Index length2);
+    void mergeLow(PowerSortState& state, Index base1, Index length1, Index base2, Index length2);
+    void mergeHigh(PowerSortState& state, Index base1, Index length1, Index base2, Index length2);
+    void heapify(Index base, Index n, Index i);
+    void heapSortRange(Index first, Index last);
+    template <int Arity>
+    void heapSortRangeArity(Index first, Index last);
+    template <int Arity>
+    Index heapAlignmentSkip(Index first, Index n) const;
+    template <int Arity>
+    void siftDown(Index base, Index n, Index i);
+    template <int Arity>
+    void siftHoleBottomUp(Index base, Index n, T&& value);
+    void mergeHeapPrefix(Index first, Index prefix, Index last);
+    void insertionSortRange(Index first, Index last);
+    bool networkSortRange(Index first, Index last);
+    void introSortLoop(Index first, Index last, int depthLimit);
+    void sort3(Index a, Index b, Index c);
+    void choosePivot(Index first, Index last);
+    Index hoarePartition(Index first, Index last);
+    void unguardedInsertionSortRange(Index first, Index last);
+    bool partialInsertionSort(Index first, Index last);
+    void pdqSortLoop(Index first, Index last, int badAllowed, bool leftmost);
+    Index partitionLeft(Index first, Index last);
+    std::pair<Index, bool> partitionRight(Index first, Index last);
+    std::pair<Index, bool> partitionRightBranchless(Index first, Index last);
+    void selectRange(Index first, Index last, Index nth);
+    void medianOfMediansPivot(Index first, Index last);
+};
+
+// floor(log2(n))，n > 0
+inline int floorLog2(size_t n) {
+    int log = 0;
+    while (n >>= 1) log++;
+    return log;
+}
+
+// 冒泡排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::bubbleSort(std::span<T> range) {
+    bind(range);
+    Index n = static_cast<Index>(range.size());
+
+    for (Index i = 0; i < n - 1; i++) {
+        bool swapped = false;
+        for (Index j = 0; j < n - i - 1; j++) {
+            if (lessAt(j + 1, j)) {
+                swap(j, j + 1);
+                swapped = true;
+            }
+        }
+        if (!swapped) break;
+    }
+}
+
+// 快速排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::quickSort(std::span<T> range) {
+    bind(range);
+    quickSortHelper(0, static_cast<Index>(range.size()) - 1);
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::quickSortHelper(Index low, Index high) {
+    if (networkSortRange(low, high + 1)) return;
+    if (low < high) {
+        Index pi = partition(low, high);
+        quickSortHelper(low, pi - 1);
+        quickSortHelper(pi + 1, high);
+    }
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+typename SortingEngine<T, Compare, Instrumentation>::Index SortingEngine<T, Compare, Instrumentation>::partition(Index low, Index high) {
+    // 枢轴 data[high] 在扫描期间保持不动
+    Index i = low - 1;
+
+    for (Index j = low; j <= high - 1; j++) {
+        if (lessAt(j, high)) {
+            i++;
+            swap(i, j);
+        }
+    }
+    swap(i + 1, high);
+    return i + 1;
+}
+
+// 归并排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::mergeSort(std::span<T> range, std::span<T> scratch) {
+    bind(range);
+    Index n = static_cast<Index>(range.size());
+    if (n < 2) return;
+
+    // 缓冲区不够时申请一次，整个排序过程中复用
+    std::vector<T> ownBuffer;
+    if (scratch.size() < range.size()) {
+        ownBuffer.resize(range.size());
+        instrumentation.allocate(range.size() * sizeof(T));
+        scratch = ownBuffer;
+    }
+
+    for (Index first = 0; first < n; first += kMergeSortRunLength) {
+        Index last = std::min(first + kMergeSortRunLength, n);
+        if (!networkSortRange(first, last)) insertionSortRange(first, last);
+    }
+
+    // 每一轮从 src 归并到 dst，然后交换两者角色
+    T* src = data;
+    T* dst = scratch.data();
+    for (Index width = kMergeSortRunLength; width < n; width *= 2) {
+        for (Index left = 0; left < n; left += 2 * width) {
+            Index mid = std::min(left + width, n);
+            Index right = std::min(left + 2 * width, n);
+            mergeRuns(src, dst, left, mid, right);
+        }
+        std::swap(src, dst);
+    }
+
+    // 结果落在缓冲区时拷回原数组
+    if (src != data) {
+        for (Index k = 0; k < n; k++) write(k, std::move(src[k]));
+    }
+}
+
+// 将 src 中相邻有序段 [left, mid) 与 [mid, right) 归并到 dst 的同一位置
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::mergeRuns(T* src, T* dst, Index left, Index mid, Index right) {
+    auto emit = [&](Index k, T&& value) {
+        if (dst == data) write(k, std::move(value));
+        else dst[k] = std::move(value);
+    };
+
+    // 两段已经首尾有序（src[mid - 1] <= src[mid]）时无需归并，直接整体搬移
+    if (mid >= right || !less(src[mid], src[mid - 1], mid, mid - 1)) {
+        for (Index k = left; k < right; k++) emit(k, std::move(src[k]));
+        return;
+    }
+
+    Index i = left, j = mid, k = left;
+    while (i < mid && j < right) {
+        // 右侧严格小于左侧时才取右侧，保持稳定性
+        if (!less(src[j], src[i], j, i)) {
+            emit(k++, std::move(src[i++]));
+        } else {
+            emit(k++, std::move(src[j++]));
+        }
+    }
+    while (i < mid) emit(k++, std::move(src[i++]));
+    while (j < right) emit(k++, std::move(src[j++]));
+}
+
+// powersort 实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::powerSort(std::span<T> range, std::span<T> scratch) {
+    bind(range);
+    Index n = static_cast<Index>(range.size());
+    if (n < 2) return;
+
+    PowerSortState state;
+    state.buffer = scratch;
+    state.bufferCapacity = range.size() / 2;
+    Index minRun = powerSortMinRun(n);
+
+    // 待归并段的栈：pending[k].power 为第 k 段与第 k + 1 段之间边界的节点幂次，自底向上严格递增
+    struct PendingRun {
+        Index start;
+        Index length;
+        int power;
+    };
+    std::array<PendingRun, kMaxPendingRuns> pending;
+    size_t depth = 0;
+
+    for (Index first = 0; first < n;) {
+        Index length = countRunAndMakeAscending(first, n);
+        if (length < minRun) {
+            Index forced = std::min(minRun, n - first);
+            binaryInsertionSort(first, first + forced, first + length);
+            length = forced;
+        }
+
+        if (depth > 0) {
+            PendingRun& top = pending[depth - 1];
+            int power = powerSortNodePower(top.start, top.length, length, n);
+            // 幂次更大的边界在归并树中更深，先归并
+            while (depth > 1 && pending[depth - 2].power > power) {
+                PendingRun& left = pending[depth - 2];
+                mergeNaturalRuns(state, left.start, left.length, pending[depth - 1].length);
+                left.length += pending[depth - 1].length;
+                depth--;
+            }
+            pending[depth - 1].power = power;
+        }
+        pending[depth++] = {first, length, 0};
+        first += length;
+    }
+
+    while (depth > 1) {
+        PendingRun& left = pending[depth - 2];
+        mergeNaturalRuns(state, left.start, left.length, pending[depth - 1].length);
+        left.length += pending[depth - 1].length;
+        depth--;
+    }
+}
+
+// 与 TimSort 相同：取 n 的最高 6 位，低位非零时加一，使 n / minRun 接近且不超过 2 的幂
+template <typename T, typename Compare, typename Instrumentation>
+typename SortingEngine<T, Compare, Instrumentation>::Index
+SortingEngine<T, Compare, Instrumentation>::powerSortMinRun(Index n) {
+    Index remainder = 0;
+    while (n >= 64) {
+        remainder |= n & 1;
+        n >>= 1;
+    }
+    return n + remainder;
+}
+
+// 相邻两段 [s1, s1 + n1) 与 [s1 + n1, s1 + n1 + n2) 的中点分别为 a/2n 与 b/2n，
+// 节点幂次是二者在 [0, 1) 的二进制展开中第一个不同位的位置（Munro & Wild, 2018）
+template <typename T, typename Compare, typename Instrumentation>
+int SortingEngine<T, Compare, Instrumentation>::powerSortNodePower(Index start1, Index length1, Index length2, Index n) {
+    Index a = 2 * start1 + length1;
+    Index b = a + length1 + length2;
+    int power = 0;
+    while (true) {
+        power++;
+        if (a >= n) {
+            a -= n;
+            b -= n;
+        } else if (b >= n) {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+// 从 first 开始的天然有序段长度；严格降序段原地翻转为升序（只翻转严格降序段，相等元素的相对顺序不变）
+template <typename T, typename Compare, typename Instrumentation>
+typename SortingEngine<T, Compare, Instrumentation>::Index
+SortingEngine<T, Compare, Instrumentation>::countRunAndMakeAscending(Index first, Index last) {
+    Index runEnd = first + 1;
+    if (runEnd == last) return 1;
+
+    if (lessAt(runEnd, first)) {
+        runEnd++;
+        while (runEnd < last && lessAt(runEnd, runEnd - 1)) runEnd++;
+        for (Index i = first, j = runEnd - 1; i < j; i++, j--) swap(i, j);
+    } else {
+        runEnd++;
+        while (runEnd < last && !lessAt(runEnd, runEnd - 1)) runEnd++;
+    }
+    return runEnd - first;
+}
+
+// [first, sortedEnd) 已有序，把 [sortedEnd, last) 逐个二分插入；相等元素插在其后，保持稳定
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::binaryInsertionSort(Index first, Index last, Index sortedEnd) {
+    for (Index i = std::max(sortedEnd, first + 1); i < last; i++) {
+        T pivot = std::move(data[i]);
+        Index lo = first, hi = i;
+        while (lo < hi) {
+            Index mid = lo + (hi - lo) / 2;
+            if (less(pivot, data[mid], -1, mid)) hi = mid;
+            else lo = mid + 1;
+        }
+        for (Index k = i; k > lo; k--) moveElement(k, k - 1);
+        write(lo, std::move(pivot));
+    }
+}
+
+// pred 在 [0, length) 上先真后假，返回第一个为假的位置（都为真时返回 length）。
+// 从 hint 起以 1, 3, 7, ... 的步长指数搜索，再在最后一步内二分：
+// 答案离 hint 为 d 时只需 O(log d) 次比较
+template <typename T, typename Compare, typename Instrumentation>
+template <typename Pred>
+typename SortingEngine<T, Compare, Instrumentation>::Index
+SortingEngine<T, Compare, Instrumentation>::gallopSearch(Pred pred, Index length, Index hint) {
+    Index lastOffset = 0, offset = 1;
+    Index lo, hi;
+    if (pred(hint)) {
+        // 答案在 hint 右侧：保持 pred(hint + lastOffset) 为真
+        Index maxOffset = length - hint;
+        while (offset < maxOffset && pred(hint + offset)) {
+            lastOffset = offset;
+            offset = (offset << 1) + 1;
+        }
+        offset = std::min(offset, maxOffset);
+        lo = hint + lastOffset + 1;
+        hi = hint + offset;
+    } else {
+        // 答案在 hint 或其左侧：保持 pred(hint - lastOffset) 为假
+        Index maxOffset = hint + 1;
+        while (offset < maxOffset && !pred(hint - offset)) {
+            lastOffset = offset;
+            offset = (offset << 1) + 1;
+        }
+        offset = std::min(offset, maxOffset);
+        lo = hint - offset + 1;
+        hi = hint - lastOffset;
+    }
+
+    while (lo < hi) {
+        Index mid = lo + (hi - lo) / 2;
+        if (pred(mid)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// 归并相邻的有序段 [base1, base1 + length1) 与 [base1 + length1, base1 + length1 + length2)
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::mergeNaturalRuns(PowerSortState& state, Index base1, Index length1,
+                                                                  Index length2) {
+    Index base2 = base1 + length1;
+
+    // 第一段中不大于 data[base2] 的前缀已在最终位置
+    Index skip = gallopSearch([&](Index k) { return !lessAt(base2, base1 + k); }, length1, 0);
+    base1 += skip;
+    length1 -= skip;
+    if (length1 == 0) return;
+
+    // 第二段中不小于第一段末元素的后缀也已在最终位置
+    Index last1 = base1 + length1 - 1;
+    length2 = gallopSearch([&](Index k) { return lessAt(base2 + k, last1); }, length2, length2 - 1);
+    if (length2 == 0) return;
+
+    // 只把较短的一段复制到缓冲区
+    Index needed = std::min(length1, length2);
+    if (static_cast<Index>(state.buffer.size()) < needed) {
+        size_t capacity = std::max(static_cast<size_t>(needed), state.bufferCapacity);
+        state.ownBuffer.resize(capacity);
+        instrumentation.allocate(capacity * sizeof(T));
+        state.buffer = state.ownBuffer;
+    }
+
+    if (length1 <= length2) mergeLow(state, base1, length1, base2, length2);
+    else mergeHigh(state, base1, length1, base2, length2);
+}
+
+// 第一段较短：复制到缓冲区后从左向右归并
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::mergeLow(PowerSortState& state, Index base1, Index length1,
+                                                          Index base2, Index length2) {
+    T* buffer = state.buffer.data();
+    std::move(data + base1, data + base1 + length1, buffer);
+
+    Index c1 = 0;       // 缓冲区中第一段的游标
+    Index c2 = base2;   // 数组中第二段的游标
+    Index dest = base1;
+    Index& minGallop = state.minGallop;
+
+    while (length1 > 0 && length2 > 0) {
+        Index count1 = 0, count2 = 0;
+
+        // 逐个比较，直到某一侧连续胜出 minGallop 次；相等时取第一段，保持稳定
+        while (length1 > 0 && length2 > 0 && (count1 | count2) < minGallop) {
+            if (less(data[c2], buffer[c1], c2, -1)) {
+                moveElement(dest++, c2++);
+                length2--;
+                count2++;
+                count1 = 0;
+            } else {
+                write(dest++, std::move(buffer[c1++]));
+                length1--;
+                count1++;
+                count2 = 0;
+            }
+        }
+
+        // galloping：成批找出一侧连续胜出的元素
+        while (length1 > 0 && length2 > 0) {
+            count1 = gallopSearch([&](Index k) { return !less(data[c2], buffer[c1 + k], c2, -1); }, length1, 0);
+            for (Index k = 0; k < count1; k++) write(dest++, std::move(buffer[c1++]));
+            length1 -= count1;
+            if (length1 == 0) break;
+
+            count2 = gallopSearch([&](Index k) { return less(data[c2 + k], buffer[c1], c2 + k, -1); }, length2, 0);
+            for (Index k = 0; k < count2; k++) moveElement(dest++, c2++);
+            length2 -= count2;
+            if (length2 == 0) break;
+
+            minGallop = std::max<Index>(minGallop - 1, 1);
+            if (count1 < kMinGallop && count2 < kMinGallop) break;
+        }
+        minGallop++;
+    }
+
+    // 第二段剩余部分已在原位；第一段剩余部分写回
+    while (length1-- > 0) write(dest++, std::move(buffer[c1++]));
+}
+
+// 第二段较短：复制到缓冲区后从右向左归并
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::mergeHigh(PowerSortState& state, Index base1, Index length1,
+                                                           Index base2, Index length2) {
+    T* buffer = state.buffer.data();
+    std::move(data + base2, data + base2 + length2, buffer);
+
+    Index c1 = base1 + length1 - 1; // 数组中第一段的游标（从右向左）
+    Index c2 = length2 - 1;         // 缓冲区中第二段的游标
+    Index dest = base2 + length2 - 1;
+    Index& minGallop = state.minGallop;
+
+    while (length1 > 0 && length2 > 0) {
+        Index count1 = 0, count2 = 0;
+
+        // 相等时先放第二段的元素（更靠右），保持稳定
+        while (length1 > 0 && length2 > 0 && (count1 | count2) < minGallop) {
+            if (less(buffer[c2], data[c1], -1, c1)) {
+                moveElement(dest--, c1--);
+                length1--;
+                count1++;
+                count2 = 0;
+            } else {
+                write(dest--, std::move(buffer[c2--]));
+                length2--;
+                count2++;
+                count1 = 0;
+            }
+        }
+
+        while (length1 > 0 && length2 > 0) {
+            // 第一段中严格大于 buffer[c2] 的后缀
+            Index keep1 = gallopSearch([&](Index k) { return !less(buffer[c2], data[base1 + k], -1, base1 + k); },
+                                       length1, length1 - 1);
+            count1 = length1 - keep1;
+            for (Index k = 0; k < count1; k++) moveElement(dest--, c1--);
+            length1 = keep1;
+            if (length1 == 0) break;
+
+            // 缓冲区中不小于 data[c1] 的后缀
+            Index keep2 = gallopSearch([&](Index k) { return less(buffer[k], data[c1], -1, c1); }, length2, length2 - 1);
+            count2 = length2 - keep2;
+            for (Index k = 0; k < count2; k++) write(dest--, std::move(buffer[c2--]));
+            length2 = keep2;
+            if (length2 == 0) break;
+
+            minGallop = std::max<Index>(minGallop - 1, 1);
+            if (count1 < kMinGallop && count2 < kMinGallop) break;
+        }
+        minGallop++;
+    }
+
+    // 第一段剩余部分已在原位；第二段剩余部分写回
+    while (length2-- > 0) write(dest--, std::move(buffer[c2--]));
+}
+
+// 堆排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::heapSort(std::span<T> range) {
+    bind(range);
+    heapSortRange(0, static_cast<Index>(range.size()));
+}
+
+// 对 [first, last) 建堆并排序，堆下标相对 first
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::heapSortRange(Index first, Index last) {
+    switch (heapArity) {
+        case 4: heapSortRangeArity<4>(first, last); break;
+        case 8: heapSortRangeArity<8>(first, last); break;
+        default: heapSortRangeArity<2>(first, last); break;
+    }
+}
+
+// 节点 i 的孩子为 Arity·i + 1 .. Arity·i + Arity。开头跳过 skip 个元素使各组孩子从对齐边界开始，
+// 这几个元素最后再归并回已排序的部分
+template <typename T, typename Compare, typename Instrumentation>
+template <int Arity>
+void SortingEngine<T, Compare, Instrumentation>::heapSortRangeArity(Index first, Index last) {
+    Index n = last - first;
+    if (n < 2) return;
+
+    Index skip = heapAlignmentSkip<Arity>(first, n);
+    Index base = first + skip;
+    Index size = n - skip;
+
+    for (Index i = (size - 2) / Arity; i >= 0; i--)
+        siftDown<Arity>(base, size, i);
+
+    // 取出末尾元素，堆顶移到末尾，再把取出的元素从根处按 Floyd 方式放回
+    for (Index i = size - 1; i > 0; i--) {
+        T value = std::move(data[base + i]);
+        moveElement(base + i, base);
+        siftHoleBottomUp<Arity>(base, i, std::move(value));
+    }
+
+    if (skip > 0) mergeHeapPrefix(first, skip, last);
+}
+
+// 对齐粒度为一组孩子的大小（Arity 个元素）与缓存行中较小者；元素大小不是 2 的幂或区间较短时不跳过。
+// 跳过的个数取决于数组的分配地址，插桩运行（计数、事件记录）一律不跳过，
+// 使比较/交换次数与事件序列只取决于输入（同排序网络快速路径，只在不插桩时启用）
+template <typename T, typename Compare, typename Instrumentation>
+template <int Arity>
+typename SortingEngine<T, Compare, Instrumentation>::Index
+SortingEngine<T, Compare, Instrumentation>::heapAlignmentSkip(Index first, Index n) const {
+    if constexpr (!std::has_single_bit(sizeof(T)) || Instrumentation::enabled) {
+        return 0;
+    } else {
+        constexpr size_t alignment = std::min(Arity * sizeof(T), kCacheLineSize);
+        auto address = reinterpret_cast<std::uintptr_t>(data + first + 1);
+        if (address % sizeof(T) != 0) return 0;
+        auto skip = static_cast<Index>((alignment - address % alignment) % alignment / sizeof(T));
+        return n >= 4 * Arity ? skip : 0;
+    }
+}
+
+// 建堆：自顶向下下沉，遇到不小于所有孩子的位置即停
+template <typename T, typename Compare, typename Instrumentation>
+template <int Arity>
+void SortingEngine<T, Compare, Instrumentation>::siftDown(Index base, Index n, Index i) {
+    while (true) {
+        Index child = Arity * i + 1;
+        if (child >= n) return;
+        Index largest = child;
+        Index end = std::min<Index>(child + Arity, n);
+        for (Index c = child + 1; c < end; c++) {
+            if (lessAt(base + largest, base + c)) largest = c;
+        }
+        if (!lessAt(base + i, base + largest)) return;
+        swap(base + i, base + largest);
+        i = largest;
+    }
+}
+
+// Floyd 自底向上下沉：空位沿最大的孩子一路下到叶子（不与 value 比较），再把 value 从叶子处上浮。
+// 排序阶段放回的元素来自堆尾、通常很小，上浮往往只需一两步，比较次数约为教科书做法的一半
+template <typename T, typename Compare, typename Instrumentation>
+template <int Arity>
+void SortingEngine<T, Compare, Instrumentation>::siftHoleBottomUp(Index base, Index n, T&& value) {
+    Index hole = 0;
+    while (true) {
+        Index child = Arity * hole + 1;
+        if (child >= n) break;
+
+        // 孙子节点是连续的 Arity² 个元素，在比较孩子的同时预取其覆盖的每个缓存行
+        Index grandchild = Arity * child + 1;
+        if (grandchild < n) {
+            auto begin = reinterpret_cast<std::uintptr_t>(data + base + grandchild);
+            auto end = reinterpret_cast<std::uintptr_t>(data + base + std::min<Index>(grandchild + Arity * Arity, n));
+            for (auto line = begin & ~(kCacheLineSize - 1); line < end; line += kCacheLineSize)
+                prefetchRead(reinterpret_cast<const void*>(line));
+        }
+
+        Index largest = child;
+        Index end = std::min<Index>(child + Arity, n);
+        for (Index c = child + 1; c < end; c++) {
+            if (lessAt(base + largest, base + c)) largest = c;
+        }
+        moveElement(base + hole, base + largest);
+        hole = largest;
+    }
+
+    while (hole > 0) {
+        Index parent = (hole - 1) / Arity;
+        if (!less(data[base + parent], value, base + parent, -1)) break;
+        moveElement(base + hole, base + parent);
+        hole = parent;
+    }
+    write(base + hole, std::move(value));
+}
+
+// [first, first + prefix) 为对齐时跳过的几个元素（prefix < 8），[first + prefix, last) 已有序：
+// 先排序前缀并暂存，再从前往后归并，写入位置始终落后于读取位置。
+// 暂存区是未初始化的存储，元素在其上就地构造，不要求 T 可默认构造
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::mergeHeapPrefix(Index first, Index prefix, Index last) {
+    insertionSortRange(first, first + prefix);
+    alignas(T) std::byte storage[8 * sizeof(T)];
+    T* buffer = reinterpret_cast<T*>(storage);
+    for (Index i = 0; i < prefix; i++) std::construct_at(buffer + i, std::move(data[first + i]));
+
+    Index i = 0;
+    Index j = first + prefix;
+    Index k = first;
+    while (i < prefix && j < last) {
+        if (less(data[j], buffer[i], j, -1)) moveElement(k++, j++);
+        else write(k++, std::move(buffer[i++]));
+    }
+    while (i < prefix) write(k++, std::move(buffer[i++]));
+    std::destroy_n(buffer, prefix);
+}
+
+// 二叉堆的下沉（部分排序与流式 top-k 使用）
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::heapify(Index base, Index n, Index i) {
+    siftDown<2>(base, n, i);
+}
+
+// 插入排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::insertionSort(std::span<T> range) {
+    bind(range);
+    insertionSortRange(0, static_cast<Index>(range.size()));
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::insertionSortRange(Index first, Index last) {
+    for (Index i = first + 1; i < last; i++) {
+        T key = std::move(data[i]);
+        Index j = i - 1;
+
+        while (j >= first && less(key, data[j], -1, j)) {
+            moveElement(j + 1, j); // 移动计入交换次数
+            j--;
+        }
+        write(j + 1, std::move(key));
+    }
+}
+
+// 小区间交给 SIMD 排序网络；不满足 kSortingNetworkLeaf 或区间过长时返回 false，由调用方自行处理
+template <typename T, typename Compare, typename Instrumentation>
+bool SortingEngine<T, Compare, Instrumentation>::networkSortRange(Index first, Index last) {
+    if constexpr (kSortingNetworkLeaf) {
+        if (last - first <= static_cast<Index>(kSortingNetworkMaxSize)) {
+            sortingNetworkSort(data + first, static_cast<size_t>(std::max<Index>(last - first, 0)));
+            return true;
+        }
+    }
+    return false;
+}
+
+// 选择排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::selectionSort(std::span<T> range) {
+    bind(range);
+    Index n = static_cast<Index>(range.size());
+
+    for (Index i = 0; i < n - 1; i++) {
+        Index minIndex = i;
+        for (Index j = i + 1; j < n; j++) {
+            if (lessAt(j, minIndex)) {
+                minIndex = j;
+            }
+        }
+        if (minIndex != i) {
+            swap(i, minIndex);
+        }
+    }
+}
+
+// 内省排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::introSort(std::span<T> range) {
+    bind(range);
+    Index n = static_cast<Index>(range.size());
+    if (n < 2) return;
+    introSortLoop(0, n, 2 * floorLog2(static_cast<size_t>(n)));
+}
+
+// 只递归较小的一侧、在较大一侧上循环，栈深度不超过 O(log n)
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::introSortLoop(Index first, Index last, int depthLimit) {
+    while (last - first > kInsertionSortCutoff) {
+        if (depthLimit == 0) {
+            heapSortRange(first, last);
+            return;
+        }
+        depthLimit--;
+
+        choosePivot(first, last);
+        Index p = hoarePartition(first, last);
+
+        if (p - first < last - (p + 1)) {
+            introSortLoop(first, p, depthLimit);
+            first = p + 1;
+        } else {
+            introSortLoop(p + 1, last, depthLimit);
+            last = p;
+        }
+    }
+    if (!networkSortRange(first, last)) insertionSortRange(first, last);
+}
+
+// 将 data[a], data[b], data[c] 排为升序
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::sort3(Index a, Index b, Index c) {
+    if (lessAt(b, a)) swap(a, b);
+    if (lessAt(c, b)) swap(b, c);
+    if (lessAt(b, a)) swap(a, b);
+}
+
+// 选取枢轴并放到 data[first]：大区间用 Tukey 九数取中，小区间用三数取中
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::choosePivot(Index first, Index last) {
+    Index mid = first + (last - first) / 2;
+    if (last - first > kNintherThreshold) {
+        sort3(first, mid, last - 1);
+        sort3(first + 1, mid - 1, last - 2);
+        sort3(first + 2, mid + 1, last - 3);
+        sort3(mid - 1, mid, mid + 1);
+        swap(first, mid);
+    } else {
+        sort3(mid, first, last - 1);
+    }
+}
+
+// Hoare 分区（枢轴位于 data[first]），返回枢轴最终位置
+// 与枢轴相等的元素会让两侧扫描都停下，重复值较多时两侧仍然均衡
+template <typename T, typename Compare, typename Instrumentation>
+typename SortingEngine<T, Compare, Instrumentation>::Index SortingEngine<T, Compare, Instrumentation>::hoarePartition(Index first, Index last) {
+    Index i = first;
+    Index j = last;
+
+    while (true) {
+        do { i++; } while (i < last && lessAt(i, first));
+        do { j--; } while (lessAt(first, j));
+        if (i >= j) break;
+        swap(i, j);
+    }
+    swap(first, j);
+    return j;
+}
+
+// 模式消除快速排序实现（参考 Orson Peters 的 pdqsort）
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::pdqSort(std::span<T> range) {
+    bind(range);
+    Index n = static_cast<Index>(range.size());
+    if (n < 2) return;
+    pdqSortLoop(0, n, floorLog2(static_cast<size_t>(n)), true);
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::pdqSortLoop(Index first, Index last, int badAllowed, bool leftmost) {
+    while (true) {
+        Index size = last - first;
+
+        // 小区间插入排序；非最左区间的左侧必有不大于它们的元素，可省去边界检查
+        if (size < kPdqInsertionSortThreshold) {
+            if (networkSortRange(first, last)) return;
+            if (leftmost) insertionSortRange(first, last);
+            else unguardedInsertionSortRange(first, last);
+            return;
+        }
+
+        choosePivot(first, last);
+
+        // 枢轴与左邻元素相等：说明区间内有大量重复值，把等于枢轴的元素整体划到左侧后跳过
+        if (!leftmost && !lessAt(first - 1, first)) {
+            first = partitionLeft(first, last) + 1;
+            continue;
+        }
+
+        auto [pivotPos, alreadyPartitioned] = kBranchlessPartition ? partitionRightBranchless(first, last)
+                                                                   : partitionRight(first, last);
+
+        Index leftSize = pivotPos - first;
+        Index rightSize = last - (pivotPos + 1);
+        bool highlyUnbalanced = leftSize < size / 8 || rightSize < size / 8;
+
+        if (highlyUnbalanced) {
+            // 不均衡次数用尽时退化为堆排序，保证 O(n log n)
+            if (--badAllowed == 0) {
+                heapSortRange(first, last);
+                return;
+            }
+
+            // 打乱部分元素以破坏导致不均衡的输入模式
+            if (leftSize >= kPdqInsertionSortThreshold) {
+                swap(first, first + leftSize / 4);
+                swap(pivotPos - 1, pivotPos - leftSize / 4);
+                if (leftSize > kNintherThreshold) {
+                    swap(first + 1, first + (leftSize / 4 + 1));
+                    swap(first + 2, first + (leftSize / 4 + 2));
+                    swap(pivotPos - 2, pivotPos - (leftSize / 4 + 1));
+                    swap(pivotPos - 3, pivotPos - (leftSize / 4 + 2));
+                }
+            }
+            if (rightSize >= kPdqInsertionSortThreshold) {
+                swap(pivotPos + 1, pivotPos + (1 + rightSize / 4));
+                swap(last - 1, last - rightSize / 4);
+                if (rightSize > kNintherThreshold) {
+                    swap(pivotPos + 2, pivotPos + (2 + rightSize / 4));
+                    swap(pivotPos + 3, pivotPos + (3 + rightSize / 4));
+                    swap(last - 2, last - (1 + rightSize / 4));
+                    swap(last - 3, last - (2 + rightSize / 4));
+                }
+            }
+        } else if (alreadyPartitioned && partialInsertionSort(first, pivotPos) &&
+                   partialInsertionSort(pivotPos + 1, last)) {
+            // 分区时未发生交换且两侧只需少量移动即有序：视为已排序
+            return;
+        }
+
+        // 递归较小的一侧，较大的一侧继续循环
+        if (leftSize < rightSize) {
+            pdqSortLoop(first, pivotPos, badAllowed, leftmost);
+            first = pivotPos + 1;
+            leftmost = false;
+        } else {
+            pdqSortLoop(pivotPos + 1, last, badAllowed, false);
+            last = pivotPos;
+        }
+    }
+}
+
+// 无边界检查的插入排序：要求 data[first - 1] 不大于区间内任何元素
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::unguardedInsertionSortRange(Index first, Index last) {
+    for (Index cur = first + 1; cur < last; cur++) {
+        if (lessAt(cur, cur - 1)) {
+            T key = std::move(data[cur]);
+            Index sift = cur;
+            do {
+                moveElement(sift, sift - 1);
+                sift--;
+            } while (less(key, data[sift - 1], -1, sift - 1));
+            write(sift, std::move(key));
+        }
+    }
+}
+
+// 尝试用插入排序完成区间，移动总数超过上限则放弃并返回 false
+template <typename T, typename Compare, typename Instrumentation>
+bool SortingEngine<T, Compare, Instrumentation>::partialInsertionSort(Index first, Index last) {
+    Index limit = 0;
+    for (Index cur = first + 1; cur < last; cur++) {
+        if (lessAt(cur, cur - 1)) {
+            T key = std::move(data[cur]);
+            Index sift = cur;
+            do {
+                moveElement(sift, sift - 1);
+                sift--;
+            } while (sift != first && less(key, data[sift - 1], -1, sift - 1));
+            write(sift, std::move(key));
+            limit += cur - sift;
+        }
+        if (limit > kPartialInsertionSortLimit) return false;
+    }
+    return true;
+}
+
+// 将等于枢轴的元素放到左侧，返回枢轴位置（其右侧元素均严格大于枢轴）
+template <typename T, typename Compare, typename Instrumentation>
+typename SortingEngine<T, Compare, Instrumentation>::Index SortingEngine<T, Compare, Instrumentation>::partitionLeft(Index first, Index last) {
+    T pivot = std::move(data[first]);
+    Index i = first;
+    Index j = last;
+
+    do --j; while (less(pivot, data[j], -1, j));
+    if (j + 1 == last) {
+        while (i < j && (++i, !less(pivot, data[i], -1, i)));
+    } else {
+        do ++i; while (!less(pivot, data[i], -1, i));
+    }
+
+    while (i < j) {
+        swap(i, j);
+        do --j; while (less(pivot, data[j], -1, j));
+        do ++i; while (!less(pivot, data[i], -1, i));
+    }
+
+    Index pivotPos = j;
+    if (pivotPos != first) moveElement(first, pivotPos);
+    write(pivotPos, std::move(pivot));
+    return pivotPos;
+}
+
+// 将小于枢轴的元素放到左侧，返回枢轴位置以及区间是否原本就已分区
+template <typename T, typename Compare, typename Instrumentation>
+std::pair<typename SortingEngine<T, Compare, Instrumentation>::Index, bool>
+SortingEngine<T, Compare, Instrumentation>::partitionRight(Index first, Index last) {
+    T pivot = std::move(data[first]);
+    Index i = first;
+    Index j = last;
+
+    // 枢轴是三数取中得到的，左右两侧各有哨兵，扫描不会越界
+    do ++i; while (less(data[i], pivot, i, -1));
+    if (i - 1 == first) {
+        while (i < j && (--j, !less(data[j], pivot, j, -1)));
+    } else {
+        do --j; while (!less(data[j], pivot, j, -1));
+    }
+
+    bool alreadyPartitioned = i >= j;
+
+    while (i < j) {
+        swap(i, j);
+        do ++i; while (less(data[i], pivot, i, -1));
+        do --j; while (!less(data[j], pivot, j, -1));
+    }
+
+    Index pivotPos = i - 1;
+    if (pivotPos != first) moveElement(first, pivotPos);
+    write(pivotPos, std::move(pivot));
+    return {pivotPos, alreadyPartitioned};
+}
+
+// BlockQuicksort 式无分支分区：先在左右两个块中把“放错侧”的元素偏移记入缓冲区
+// （比较结果直接累加到计数上，不产生条件跳转），再成对交换
+template <typename T, typename Compare, typename Instrumentation>
+std::pair<typename SortingEngine<T, Compare, Instrumentation>::Index, bool>
+SortingEngine<T, Compare, Instrumentation>::partitionRightBranchless(Index first, Index last) {
+    T pivot = std::move(data[first]);
+    Index i = first;
+    Index j = last;
+
+    do ++i; while (less(data[i], pivot, i, -1));
+    if (i - 1 == first) {
+        while (i < j && (--j, !less(data[j], pivot, j, -1)));
+    } else {
+        do --j; while (!less(data[j], pivot, j, -1));
+    }
+
+    bool alreadyPartitioned = i >= j;
+    if (!alreadyPartitioned) {
+        swap(i, j);
+        i++;
+
+        alignas(64) unsigned char offsetsLeft[kPartitionBlockSize];
+        alignas(64) unsigned char offsetsRight[kPartitionBlockSize];
+        Index leftBase = i;
+        Index rightBase = j;
+        Index numLeft = 0, numRight = 0, startLeft = 0, startRight = 0;
+
+        while (i < j) {
+            // 未知区间不足两个块时按剩余长度拆分
+            Index unknown = j - i;
+            Index leftSplit = numLeft == 0 ? (numRight == 0 ? unknown / 2 : unknown) : 0;
+            Index rightSplit = numRight == 0 ? (unknown - leftSplit) : 0;
+            Index leftCount = std::min(leftSplit, kPartitionBlockSize);
+            Index rightCount = std::min(rightSplit, kPartitionBlockSize);
+
+            for (Index k = 0; k < leftCount; k++) {
+                offsetsLeft[numLeft] = static_cast<unsigned char>(k);
+                numLeft += !less(data[i], pivot, i, -1);
+                i++;
+            }
+            for (Index k = 0; k < rightCount; k++) {
+                offsetsRight[numRight] = static_cast<unsigned char>(k + 1);
+                --j;
+                numRight += less(data[j], pivot, j, -1);
+            }
+
+            Index num = std::min(numLeft, numRight);
+            for (Index k = 0; k < num; k++) {
+                swap(leftBase + offsetsLeft[startLeft + k], rightBase - offsetsRight[startRight + k]);
+            }
+            numLeft -= num;
+            numRight -= num;
+            startLeft += num;
+            startRight += num;
+            if (numLeft == 0) {
+                startLeft = 0;
+                leftBase = i;
+            }
+            if (numRight == 0) {
+                startRight = 0;
+                rightBase = j;
+            }
+        }
+
+        // 收尾：把一侧剩余的错位元素挪到分界处
+        if (numLeft) {
+            while (numLeft--) swap(leftBase + offsetsLeft[startLeft + numLeft], --j);
+            i = j;
+        }
+        if (numRight) {
+            while (numRight--) {
+                swap(rightBase - offsetsRight[startRight + numRight], i);
+                i++;
+            }
+            j = i;
+        }
+    }
+
+    Index pivotPos = i - 1;
+    if (pivotPos != first) moveElement(first, pivotPos);
+    write(pivotPos, std::move(pivot));
+    return {pivotPos, alreadyPartitioned};
+}
+
+// 部分排序实现
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::partialSort(std::span<T> range, size_t k) {
+    bind(range);
+    Index n = static_cast<Index>(range.size());
+    Index count = std::min(static_cast<Index>(k), n);
+    if (count == 0) return;
+
+    if (count > n / kPartialSortHeapDivisor) {
+        if (count < n) selectRange(0, n, count);
+        pdqSortLoop(0, count, floorLog2(static_cast<size_t>(count)), true);
+        return;
+    }
+
+    for (Index i = count / 2 - 1; i >= 0; i--)
+        heapify(0, count, i);
+    for (Index i = count; i < n; i++) {
+        if (lessAt(i, 0)) {
+            swap(0, i);
+            heapify(0, count, 0);
+        }
+    }
+    for (Index i = count - 1; i > 0; i--) {
+        swap(0, i);
+        heapify(0, i, 0);
+    }
+}
+
+// 选择实现（introselect）
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::nthElement(std::span<T> range, size_t k) {
+    bind(range);
+    if (k >= range.size()) return;
+    selectRange(0, static_cast<Index>(range.size()), static_cast<Index>(k));
+}
+
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::selectRange(Index first, Index last, Index nth) {
+    int depthLimit = 2 * floorLog2(static_cast<size_t>(std::max<Index>(last - first, 1)));
+    while (last - first > kInsertionSortCutoff) {
+        if (depthLimit > 0) {
+            depthLimit--;
+            choosePivot(first, last);
+        } else {
+            medianOfMediansPivot(first, last);
+        }
+
+        Index p = hoarePartition(first, last);
+        if (p == nth) return;
+        if (nth < p) last = p;
+        else first = p + 1;
+    }
+    insertionSortRange(first, last);
+}
+
+// 每 5 个元素一组取中位数并集中到区间开头，递归选出这些中位数的中位数作为枢轴放到 data[first]；
+// 这样的枢轴两侧至少各有约 3/10 的元素，每轮分区后区间至少缩小到 7/10
+template <typename T, typename Compare, typename Instrumentation>
+void SortingEngine<T, Compare, Instrumentation>::medianOfMediansPivot(Index first, Index last) {
+    Index groups = (last - first) / 5;
+    for (Index g = 0; g < groups; g++) {
+        Index start = first + 5 * g;
+        insertionSortRange(start, start + 5);
+        swap(first + g, start + 2);
+    }
+    Index mid = first + groups / 2;
+    selectRange(first, first + groups, mid);
+    swap(first, mid);
+}
+
+// 流式 top-k：逐个接收元素，只保留 comp 意义下最小的 k 个（std::greater 时为最大的 k 个），内存 O(k)。
+// 先收满 k 个再一次建大顶堆；此后新元素小于堆顶时替换堆顶并下沉，否则只花一次比较。
+// 比较/交换经由引擎的插桩钩子，下标指堆缓冲区中的位置
+template <typename T, typename Compare = std::less<T>, typename Instrumentation = CountingInstrumentation>
+class TopKSelector {
+public:
+    using Engine = SortingEngine<T, Compare, Instrumentation>;
+    using Index = typename Engine::Index;
+
+    explicit TopKSelector(size_t k, Compare comp = Compare()) : engine(comp), k(k) {
+        heap.reserve(k);
+        engine.resetCounters();
+    }
+
+    void push(T value) {
+        if (k == 0) return;
+        if (heap.size() < k) {
+            heap.push_back(std::move(value));
+            if (heap.size() == k) buildHeap();
+            return;
+        }
+        engine.data = heap.data();
+        if (engine.less(value, heap[0], -1, 0)) {
+            engine.write(0, std::move(value));
+            engine.heapify(0, static_cast<Index>(k), 0);
+        }
+    }
+
+    void push(std::span<const T> values) {
+        for (const T& value : values) push(value);
+    }
+
+    size_t size() const { return heap.size(); }
+
+    // 取出结果（升序）并清空；不足 k 个时返回全部已接收的元素
+    std::vector<T> takeSorted() {
+        engine.data = heap.data();
+        Index n = static_cast<Index>(heap.size());
+        if (n < static_cast<Index>(k)) {
+            for (Index i = n / 2 - 1; i >= 0; i--) engine.heapify(0, n, i);
+        }
+        for (Index i = n - 1; i > 0; i--) {
+            engine.swap(0, i);
+            engine.heapify(0, i, 0);
+        }
+        std::vector<T> result = std::move(heap);
+        heap.clear();
+        return result;
+    }
+
+    void resetCounters() { engine.resetCounters(); }
+    size_t getComparisons() const { return engine.getComparisons(); }
+    size_t getSwaps() const { return engine.getSwaps(); }
+
+private:
+    Engine engine;
+    std::vector<T> heap;
+    size_t k;
+
+    void buildHeap() {
+        engine.data = heap.data();
+        Index n = static_cast<Index>(heap.size());
+        for (Index i = n / 2 - 1; i >= 0; i--) engine.heapify(0, n, i);
+    }
+};
+
+#endif // SORTING_ENGINE_H
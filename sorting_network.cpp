@@ -0,0 +1,216 @@
+#include "sorting_network.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+// SIMD 版本基于 GCC 向量扩展编写，在带 target 属性的函数中内联展开，
+// 由编译器生成对应指令集的代码；其他编译器只使用标量版本
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define SORTING_NETWORK_SIMD 1
+#endif
+
+namespace {
+
+template <typename T>
+using BlockKernel = void (*)(T*);
+
+// 块大小 8/16/32/64 对应的排序函数
+template <typename T>
+using KernelSet = std::array<BlockKernel<T>, 4>;
+
+// 标量回退：插入排序（在标量代码中比同规模的排序网络更快）
+template <typename T>
+void insertionSortSmall(T* a, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        T key = a[i];
+        size_t j = i;
+        while (j > 0 && key < a[j - 1]) {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = key;
+    }
+}
+
+#ifdef SORTING_NETWORK_SIMD
+
+template <typename T, size_t Bytes>
+struct VectorOf {
+    typedef T Type __attribute__((vector_size(Bytes)));
+};
+
+// 与 T 等宽的整数，用作通道下标与比较结果
+template <typename T>
+using LaneOf = std::conditional_t<sizeof(T) == 4, int32_t, int64_t>;
+
+// 双调排序网络：k 为当前合并的双调序列长度，j 为比较交换的步长；
+// 元素 i 与 i ^ j 比较，(i & k) == 0 的一组升序、其余降序，最后一阶 k == N 整体升序。
+// N 个元素放在 N / L 个向量寄存器中（每个 L 个通道）。
+// 步长 j >= L 时比较交换发生在两个寄存器的对应通道之间；
+// j < L 时在寄存器内部用置换取得配对元素，再按通道选择 min 或 max
+template <typename T, size_t Bytes, size_t N>
+[[gnu::always_inline]] inline void bitonicSortVector(T* a) {
+    using V = typename VectorOf<T, Bytes>::Type;
+    using Lane = LaneOf<T>;
+    using M = typename VectorOf<Lane, Bytes>::Type;
+    constexpr size_t L = Bytes / sizeof(T);
+    constexpr size_t R = N / L;
+
+    V regs[R];
+    std::memcpy(regs, a, sizeof(regs));
+
+    M lane;
+    for (size_t l = 0; l < L; l++) lane[l] = static_cast<Lane>(l);
+
+#pragma GCC unroll 8
+    for (size_t k = 2; k <= N; k *= 2) {
+#pragma GCC unroll 8
+        for (size_t j = k / 2; j > 0; j /= 2) {
+            if (j >= L) {
+                size_t stride = j / L;
+#pragma GCC unroll 32
+                for (size_t r = 0; r < R; r++) {
+                    if (r & stride) continue;
+                    V& x = regs[r];
+                    V& y = regs[r ^ stride];
+                    M less = x < y;
+                    V lo = less ? x : y;
+                    V hi = less ? y : x;
+                    bool ascending = ((r * L) & k) == 0;
+                    x = ascending ? lo : hi;
+                    y = ascending ? hi : lo;
+                }
+            } else {
+                M permutation = lane ^ static_cast<Lane>(j);
+                M upper = (lane & static_cast<Lane>(j)) != 0;
+#pragma GCC unroll 32
+                for (size_t r = 0; r < R; r++) {
+                    V partner = __builtin_shuffle(regs[r], permutation);
+                    M less = regs[r] < partner;
+                    V lo = less ? regs[r] : partner;
+                    V hi = less ? partner : regs[r];
+                    M descending = ((lane + static_cast<Lane>(r * L)) & static_cast<Lane>(k)) != 0;
+                    regs[r] = (upper ^ descending) ? hi : lo;
+                }
+            }
+        }
+    }
+
+    std::memcpy(a, regs, sizeof(regs));
+}
+
+template <typename T, size_t N>
+[[gnu::target("avx2")]] void bitonicSortAvx2(T* a) {
+    bitonicSortVector<T, 32, N>(a);
+}
+
+template <typename T, size_t N>
+[[gnu::target("sse4.1")]] void bitonicSortSse41(T* a) {
+    bitonicSortVector<T, 16, N>(a);
+}
+
+// 8 个 32 位元素只占一个 AVX2 寄存器，寄存器内置换多于跨寄存器比较，用 SSE4.1 版本更快
+template <typename T>
+const KernelSet<T> kAvx2Kernels = {
+    sizeof(T) == 4 ? bitonicSortSse41<T, 8> : bitonicSortAvx2<T, 8>,
+    bitonicSortAvx2<T, 16>, bitonicSortAvx2<T, 32>, bitonicSortAvx2<T, 64>
+};
+
+template <typename T>
+const KernelSet<T> kSse41Kernels = {
+    bitonicSortSse41<T, 8>, bitonicSortSse41<T, 16>, bitonicSortSse41<T, 32>, bitonicSortSse41<T, 64>
+};
+
+#endif // SORTING_NETWORK_SIMD
+
+std::atomic<SimdLevel>& activeLevel() {
+    static std::atomic<SimdLevel> level{detectSimdLevel()};
+    return level;
+}
+
+// 返回 nullptr 表示使用标量回退；
+// SSE4.1 没有 64 位整数比较指令（pcmpgtq 属于 SSE4.2），int64 在该级别也使用标量回退
+template <typename T>
+const KernelSet<T>* kernelsFor(SimdLevel level) {
+#ifdef SORTING_NETWORK_SIMD
+    if (level == SimdLevel::AVX2) return &kAvx2Kernels<T>;
+    if (level == SimdLevel::SSE41 && !std::is_same_v<T, int64_t>) return &kSse41Kernels<T>;
+#endif
+    (void)level;
+    return nullptr;
+}
+
+// 填充值排在所有元素之后，排序后留在块尾不会被拷回
+template <typename T>
+T paddingValue() {
+    if constexpr (std::numeric_limits<T>::has_infinity) return std::numeric_limits<T>::infinity();
+    else return std::numeric_limits<T>::max();
+}
+
+template <typename T>
+void sortSmall(T* a, size_t n) {
+    if (n < 2) return;
+
+    const KernelSet<T>* kernels = kernelsFor<T>(activeLevel().load(std::memory_order_relaxed));
+    if (!kernels) {
+        insertionSortSmall(a, n);
+        return;
+    }
+
+    size_t index = n <= 8 ? 0 : n <= 16 ? 1 : n <= 32 ? 2 : 3;
+    size_t block = size_t(8) << index;
+    BlockKernel<T> kernel = (*kernels)[index];
+
+    if (n == block) {
+        kernel(a);
+        return;
+    }
+
+    alignas(64) T buffer[kSortingNetworkMaxSize];
+    std::memcpy(buffer, a, n * sizeof(T));
+    std::fill(buffer + n, buffer + block, paddingValue<T>());
+    kernel(buffer);
+    std::memcpy(a, buffer, n * sizeof(T));
+}
+
+} // namespace
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "Scalar";
+        case SimdLevel::SSE41:  return "SSE4.1";
+        case SimdLevel::AVX2:   return "AVX2";
+    }
+    return "Unknown";
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef SORTING_NETWORK_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE41;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel getSimdLevel() {
+    return activeLevel().load(std::memory_order_relaxed);
+}
+
+void setSimdLevel(SimdLevel level) {
+    activeLevel().store(std::min(level, detectSimdLevel()), std::memory_order_relaxed);
+}
+
+void sortingNetworkSort(int32_t* a, size_t n) {
+    sortSmall(a, n);
+}
+
+void sortingNetworkSort(int64_t* a, size_t n) {
+    sortSmall(a, n);
+}
+
+void sortingNetworkSort(float* a, size_t n) {
+    sortSmall(a, n);
+}
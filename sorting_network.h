@@ -0,0 +1,40 @@
+#ifndef SORTING_NETWORK_H
+#define SORTING_NETWORK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// 小数组排序网络（双调排序），作为快速/归并/基数排序的叶子排序
+// 按 8/16/32/64 元素的块排序，不足一块的用最大值填充；
+// 运行时检测 CPU 选择 AVX2 / SSE4.1 实现，不支持时回退为标量插入排序，结果与升序 std::sort 一致。
+
+// 可用排序网络的元素类型（仅限默认升序比较）
+template <typename T>
+concept SortingNetworkSortable =
+    std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t> || std::is_same_v<T, float>;
+
+// 排序网络一次能处理的最大元素数
+inline constexpr size_t kSortingNetworkMaxSize = 64;
+
+enum class SimdLevel {
+    Scalar,
+    SSE41,
+    AVX2
+};
+
+const char* simdLevelName(SimdLevel level);
+
+// 当前 CPU（及编译器）支持的最高指令集
+SimdLevel detectSimdLevel();
+
+// 排序网络实际使用的指令集；setSimdLevel 可降级（用于对比测试），不会超过 detectSimdLevel()
+SimdLevel getSimdLevel();
+void setSimdLevel(SimdLevel level);
+
+// 对 a[0, n) 升序排序，要求 n <= kSortingNetworkMaxSize
+void sortingNetworkSort(int32_t* a, size_t n);
+void sortingNetworkSort(int64_t* a, size_t n);
+void sortingNetworkSort(float* a, size_t n);
+
+#endif // SORTING_NETWORK_H
@@ -1,230 +1,203 @@
 #include "sorting_system.h"
+#include "parallel_sort.h"
+#include "dataset_io.h"
+#include "benchmark.h"
 #include <iostream>
 #include <iomanip>
 
-SortingSystem::SortingSystem() : comparisonCount(0), swapCount(0) {}
+SortingSystem::SortingSystem() : dataSeed(0), threadCount(0) {}
 
-void SortingSystem::resetCounters() const {
-    comparisonCount = 0;
-    swapCount = 0;
+void SortingSystem::setThreadCount(size_t count) {
+    if (count != threadCount) {
+        threadCount = count;
+        threadPool.reset();
+    }
+}
+
+ThreadPool& SortingSystem::getThreadPool() {
+    if (!threadPool) {
+        threadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+    return *threadPool;
 }
 
-void SortingSystem::generateData(size_t size, DataPattern pattern) {
-    data = generateTestData(size, pattern);
+void SortingSystem::generateData(size_t size, DataPattern pattern, const PatternParams& params) {
+    dataSeed = fixedSeed ? *fixedSeed : randomSeed();
+    data = generateTestData(size, pattern, dataSeed, &getThreadPool(), params);
     originalData = data;
+    scratchBuffer.resize(data.size());
 }
 
 void SortingSystem::setData(const std::vector<int>& newData) {
     data = newData;
     originalData = newData;
+    scratchBuffer.resize(data.size());
 }
 
 void SortingSystem::resetData() {
     data = originalData;
 }
 
-void SortingSystem::swap(int& a, int& b) {
-    if (&a != &b) {
-        int temp = a;
-        a = b;
-        b = temp;
-        swapCount++;
+void SortingSystem::loadDataset(const std::string& path) {
+    MappedDataset dataset(path);
+    std::span<int32_t> values = dataset.elements<int32_t>();
+    data.assign(values.begin(), values.end());
+    originalData = data;
+    scratchBuffer.resize(data.size());
+}
+
+void SortingSystem::saveDataset(const std::string& path) const {
+    writeDataset<int32_t>(path, data);
+}
+
+// 按插桩策略执行选择算法，topK 的结果写入 selection
+template <typename Instrumentation>
+static SortOperationCounts runSelection(SelectionAlgorithm algorithm, std::span<int> data, size_t k,
+                                        std::vector<int>& selection) {
+    SortOperationCounts counts;
+    if (algorithm == SelectionAlgorithm::TopKStream) {
+        TopKSelector<int, std::less<int>, Instrumentation> selector(k);
+        selector.push(std::span<const int>(data));
+        selection = selector.takeSorted();
+        counts.comparisons = selector.getComparisons();
+        counts.swaps = selector.getSwaps();
+        counts.allocations = k > 0 ? 1 : 0; // 堆缓冲区一次性预留 k 个元素
+        return counts;
     }
+    SortingEngine<int, std::less<int>, Instrumentation> engine;
+    if (algorithm == SelectionAlgorithm::PartialSort) engine.partialSort(data, k);
+    else engine.nthElement(data, k);
+    counts.comparisons = engine.getComparisons();
+    counts.swaps = engine.getSwaps();
+    counts.allocations = engine.getAllocations();
+    return counts;
 }
 
-// 冒泡排序实现
+// 排序算法实现：全部经由 dispatchSort（parallel_sort.h），归并类算法复用 scratchBuffer，并行算法使用线程池
 void SortingSystem::bubbleSort() {
-    resetCounters();
-    int n = data.size();
-    bool swapped;
-    
-    for (int i = 0; i < n - 1; i++) {
-        swapped = false;
-        for (int j = 0; j < n - i - 1; j++) {
-            incrementComparisons();
-            if (data[j] > data[j + 1]) {
-                swap(data[j], data[j + 1]);
-                swapped = true;
-            }
-        }
-        if (!swapped) break;
-    }
+    sort(SortAlgorithm::BubbleSort);
 }
 
-// 快速排序实现
 void SortingSystem::quickSort() {
-    resetCounters();
-    quickSortHelper(0, data.size() - 1);
+    sort(SortAlgorithm::QuickSort);
 }
 
-void SortingSystem::quickSortHelper(int low, int high) {
-    if (low < high) {
-        int pi = partition(low, high);
-        quickSortHelper(low, pi - 1);
-        quickSortHelper(pi + 1, high);
-    }
+void SortingSystem::mergeSort() {
+    sort(SortAlgorithm::MergeSort);
 }
 
-int SortingSystem::partition(int low, int high) {
-    int pivot = data[high];
-    int i = low - 1;
-
-    for (int j = low; j <= high - 1; j++) {
-        incrementComparisons();
-        if (data[j] < pivot) {
-            i++;
-            swap(data[i], data[j]);
-        }
-    }
-    swap(data[i + 1], data[high]);
-    return i + 1;
+void SortingSystem::powerSort() {
+    sort(SortAlgorithm::PowerSort);
 }
 
-// 归并排序实现
-void SortingSystem::mergeSort() {
-    resetCounters();
-    mergeSortHelper(0, data.size() - 1);
+void SortingSystem::heapSort() {
+    sort(SortAlgorithm::HeapSort);
 }
 
-void SortingSystem::mergeSortHelper(int left, int right) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-        mergeSortHelper(left, mid);
-        mergeSortHelper(mid + 1, right);
-        merge(left, mid, right);
-    }
+void SortingSystem::insertionSort() {
+    sort(SortAlgorithm::InsertionSort);
 }
 
-void SortingSystem::merge(int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
+void SortingSystem::selectionSort() {
+    sort(SortAlgorithm::SelectionSort);
+}
 
-    std::vector<int> leftArray(n1);
-    std::vector<int> rightArray(n2);
+void SortingSystem::introSort() {
+    sort(SortAlgorithm::IntroSort);
+}
 
-    for (int i = 0; i < n1; i++)
-        leftArray[i] = data[left + i];
-    for (int j = 0; j < n2; j++)
-        rightArray[j] = data[mid + 1 + j];
+void SortingSystem::pdqSort() {
+    sort(SortAlgorithm::PdqSort);
+}
 
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        incrementComparisons();
-        if (leftArray[i] <= rightArray[j]) {
-            data[k] = leftArray[i];
-            i++;
-        } else {
-            data[k] = rightArray[j];
-            j++;
-        }
-        k++;
-    }
+void SortingSystem::parallelMergeSort() {
+    sort(SortAlgorithm::ParallelMergeSort);
+}
 
-    while (i < n1) {
-        data[k] = leftArray[i];
-        i++;
-        k++;
-    }
+void SortingSystem::parallelQuickSort() {
+    sort(SortAlgorithm::ParallelQuickSort);
+}
 
-    while (j < n2) {
-        data[k] = rightArray[j];
-        j++;
-        k++;
-    }
+void SortingSystem::radixSortLSD() {
+    sort(SortAlgorithm::RadixSortLSD);
 }
 
-// 堆排序实现
-void SortingSystem::heapSort() {
-    resetCounters();
-    int n = data.size();
+void SortingSystem::radixSortMSD() {
+    sort(SortAlgorithm::RadixSortMSD);
+}
 
-    for (int i = n / 2 - 1; i >= 0; i--)
-        heapify(n, i);
+// 计数插桩；基数排序不做比较，以遍数和搬移字节数作为统计
+void SortingSystem::sort(SortAlgorithm algorithm) {
+    lastStats = dispatchSort<int>(algorithm, data, scratchBuffer, &getThreadPool());
+}
 
-    for (int i = n - 1; i > 0; i--) {
-        swap(data[0], data[i]);
-        heapify(i, 0);
-    }
+void SortingSystem::partialSort(size_t k) {
+    select(SelectionAlgorithm::PartialSort, k);
 }
 
-void SortingSystem::heapify(int n, int i) {
-    int largest = i;
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
+void SortingSystem::nthElement(size_t k) {
+    select(SelectionAlgorithm::NthElement, k);
+}
 
-    if (left < n) {
-        incrementComparisons();
-        if (data[left] > data[largest])
-            largest = left;
-    }
+void SortingSystem::topK(size_t k) {
+    select(SelectionAlgorithm::TopKStream, k);
+}
 
-    if (right < n) {
-        incrementComparisons();
-        if (data[right] > data[largest])
-            largest = right;
-    }
+void SortingSystem::select(SelectionAlgorithm algorithm, size_t k) {
+    lastStats = runSelection<CountingInstrumentation>(algorithm, data, k, selection);
+}
 
-    if (largest != i) {
-        swap(data[i], data[largest]);
-        heapify(n, largest);
-    }
+const PerfCounterGroup& SortingSystem::getPerfCounters() {
+    if (!perfCounters) perfCounters = std::make_unique<PerfCounterGroup>();
+    return *perfCounters;
 }
 
-// 插入排序实现
-void SortingSystem::insertionSort() {
-    resetCounters();
-    int n = data.size();
-    
-    for (int i = 1; i < n; i++) {
-        int key = data[i];
-        int j = i - 1;
-        
-        while (j >= 0) {
-            incrementComparisons();
-            if (data[j] > key) {
-                data[j + 1] = data[j];
-                j--;
-                swapCount++; // 记录移动次数
-            } else {
-                break;
-            }
-        }
-        data[j + 1] = key;
-    }
+SortPerformance SortingSystem::testAlgorithm(const std::string& algorithmName, SortAlgorithm algorithm) {
+    // 整数上观察不到稳定性，改用带原始下标的记录实测
+    bool isStable = probeSortStability(algorithm, getThreadPool());
+    auto timedRun = [&] {
+        dispatchSort<int, std::less<int>, NoInstrumentation>(algorithm, data, scratchBuffer, &getThreadPool());
+    };
+    return measure(algorithmName, timedRun, [&] { sort(algorithm); }, isStable);
 }
 
-// 选择排序实现
-void SortingSystem::selectionSort() {
-    resetCounters();
-    int n = data.size();
-    
-    for (int i = 0; i < n - 1; i++) {
-        int minIndex = i;
-        for (int j = i + 1; j < n; j++) {
-            incrementComparisons();
-            if (data[j] < data[minIndex]) {
-                minIndex = j;
-            }
-        }
-        if (minIndex != i) {
-            swap(data[i], data[minIndex]);
-        }
-    }
+// 选择算法只保证前 k 个（或第 k 个）位置，稳定性无意义，记为不稳定
+SortPerformance SortingSystem::testSelection(const std::string& algorithmName, SelectionAlgorithm algorithm, size_t k) {
+    auto timedRun = [&] { runSelection<NoInstrumentation>(algorithm, data, k, selection); };
+    return measure(algorithmName, timedRun, [&] { select(algorithm, k); }, false);
 }
 
-SortPerformance SortingSystem::testAlgorithm(const std::string& algorithmName, void (SortingSystem::*sortFunc)()) {
+SortPerformance SortingSystem::measure(const std::string& algorithmName, const std::function<void()>& timedRun,
+                                       const std::function<void()>& countedRun, bool stable) {
+    bool measureHardware = getPerfCounters().available();
+    HardwareCounters hardwareTotal;
+    std::vector<double> samples;
+    double elapsed = 0.0;
+    do {
+        resetData();
+        if (measureHardware) perfCounters->start();
+        auto start = std::chrono::steady_clock::now();
+        timedRun();
+        auto end = std::chrono::steady_clock::now();
+        if (measureHardware) hardwareTotal += perfCounters->stop();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        elapsed += samples.back();
+    } while (samples.size() < kMaxTrials && elapsed < kTrialTimeBudgetMs);
+    size_t runs = samples.size();
+    TimingSummary timing = summarizeTimings(std::move(samples));
+
     resetData();
-    auto start = std::chrono::high_resolution_clock::now();
-    (this->*sortFunc)();
-    auto end = std::chrono::high_resolution_clock::now();
-    
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    double timeInMs = duration.count() / 1000.0;
-    
-    // 简单判断稳定性（对于整数来说较难体现，这里仅作示例）
-    bool isStable = (algorithmName == "Merge Sort" || algorithmName == "Bubble Sort" || algorithmName == "Insertion Sort");
-    
-    return SortPerformance(algorithmName, timeInMs, comparisonCount, swapCount, isStable);
+    countedRun();
+
+    SortPerformance perf(algorithmName, timing.median, getComparisons(), getSwaps(), stable);
+    perf.trials = timing.samples;
+    perf.timeMin = timing.min;
+    perf.timeStddev = timing.stddev;
+    perf.allocations = getAllocations();
+    perf.passes = getPasses();
+    perf.bytesMoved = getBytesMoved();
+    perf.hardware = hardwareTotal.dividedBy(runs);
+    return perf;
 }
 
 bool SortingSystem::isSorted() const {
@@ -245,37 +218,10 @@ void SortingSystem::printData() const {
 }
 
 std::vector<int> SortingSystem::generateTestData(size_t size, DataPattern pattern) {
-    std::vector<int> testData(size);
-    
-    // 初始化顺序数据
-    for (size_t i = 0; i < size; i++) {
-        testData[i] = static_cast<int>(i + 1);
-    }
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    
-    switch (pattern) {
-        case DataPattern::Random:
-            std::shuffle(testData.begin(), testData.end(), gen);
-            break;
-            
-        case DataPattern::Descending:
-            std::reverse(testData.begin(), testData.end());
-            break;
-            
-        case DataPattern::PartiallySorted:
-            // 将大约70%的数据保持有序，其余打乱
-            if (size > 10) {
-                size_t unsortedSize = size * 0.3;
-                std::shuffle(testData.end() - unsortedSize, testData.end(), gen);
-            }
-            break;
-            
-        case DataPattern::Ascending:
-            // 默认就是升序，无需处理
-            break;
-    }
-    
-    return testData;
+    return generateTestData(size, pattern, randomSeed());
+}
+
+std::vector<int> SortingSystem::generateTestData(size_t size, DataPattern pattern, uint64_t seed, ThreadPool* pool,
+                                                 const PatternParams& params) {
+    return generatePatternData<int>(size, pattern, params, seed, pool);
 }
\ No newline at end of file
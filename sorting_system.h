@@ -7,6 +7,15 @@
 #include <algorithm>
 #include <random>
 #include <iostream>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include "sorting_engine.h"
+#include "thread_pool.h"
+#include "parallel_sort.h"
+#include "perf_counters.h"
+#include "data_generator.h"
 
 // 排序算法性能比较结果结构体
 struct SortPerformance {
@@ -14,69 +23,115 @@ struct SortPerformance {
     double timeTaken; // 毫秒
     size_t comparisons;
     size_t swaps;
-    bool stable;
+    bool stable;            // 实测稳定性（见 benchmark.h 的 probeSortStability）
+    size_t allocations = 0; // 单次排序中的堆内存申请次数
+    size_t passes = 0;      // 基数排序的分配遍数（非比较排序以此代替比较次数）
+    size_t bytesMoved = 0;  // 基数排序搬移元素的总字节数
+    size_t trials = 1;      // 计时次数，timeTaken 为其中位数
+    double timeMin = 0.0;
+    double timeStddev = 0.0;
+    HardwareCounters hardware; // 每次排序的平均硬件计数（与计时同为不插桩运行），不可用时为空
 
     SortPerformance(const std::string& name, double time, size_t comp, size_t sw, bool st) 
         : algorithmName(name), timeTaken(time), comparisons(comp), swaps(sw), stable(st) {}
 };
 
-// 数据生成类型枚举
-enum class DataPattern {
-    Random,
-    Ascending,
-    Descending,
-    PartiallySorted
-};
-
 class SortingSystem {
 private:
     std::vector<int> data;
     std::vector<int> originalData;
+    // 数据生成种子：fixedSeed 为空时每次生成都取新的随机种子，dataSeed 为最近一次实际使用的种子
+    std::optional<uint64_t> fixedSeed;
+    uint64_t dataSeed;
     
-    // 性能统计变量
-    mutable size_t comparisonCount;
-    mutable size_t swapCount;
+    // 归并排序复用的缓冲区，随数据量一次性分配
+    std::vector<int> scratchBuffer;
+
+    // 并行算法使用的线程池（按需创建）
+    size_t threadCount;
+    std::unique_ptr<ThreadPool> threadPool;
+    ThreadPool& getThreadPool();
+
+    // 硬件性能计数器（首次性能测试时打开）
+    std::unique_ptr<PerfCounterGroup> perfCounters;
+
+    // 最近一次排序的统计结果
+    SortOperationCounts lastStats;
 
-    // 辅助函数用于性能统计
-    void resetCounters() const;
-    void incrementComparisons() const { comparisonCount++; }
-    void incrementSwaps() const { swapCount++; }
+    // 流式 top-k 的结果
+    std::vector<int> selection;
+
+    // 重复计时不插桩的 timedRun（每次前恢复原始数据），硬件计数器只包住这些运行；
+    // 之后恢复数据单独运行一次计数插桩的 countedRun，比较/交换等统计取自这一次
+    SortPerformance measure(const std::string& algorithmName, const std::function<void()>& timedRun,
+                            const std::function<void()>& countedRun, bool stable);
 
 public:
     // 构造和数据管理
     SortingSystem();
-    void generateData(size_t size, DataPattern pattern);
+    void generateData(size_t size, DataPattern pattern, const PatternParams& params = PatternParams());
+    // 固定之后的生成都使用 seed（相同的大小与分布得到相同的数据），传入空值恢复为每次随机
+    void setSeed(std::optional<uint64_t> seed) { fixedSeed = seed; }
+    const std::optional<uint64_t>& getFixedSeed() const { return fixedSeed; }
+    uint64_t getDataSeed() const { return dataSeed; }
     void setData(const std::vector<int>& newData);
     const std::vector<int>& getData() const { return data; }
     const std::vector<int>& getOriginalData() const { return originalData; }
     void resetData();
+    // 二进制数据集文件（dataset_io.h）：载入时要求元素类型为 int32
+    void loadDataset(const std::string& path);
+    void saveDataset(const std::string& path) const;
 
     // 排序算法实现
     void bubbleSort();
     void quickSort();
     void mergeSort();
+    void powerSort();
     void heapSort();
     void insertionSort();
     void selectionSort();
+    void introSort();
+    void pdqSort();
+    void parallelMergeSort();
+    void parallelQuickSort();
+    void radixSortLSD();
+    void radixSortMSD();
+
+    void sort(SortAlgorithm algorithm);
 
-    // 排序算法辅助函数
-    void quickSortHelper(int low, int high);
-    int partition(int low, int high);
-    void merge(int left, int mid, int right);
-    void mergeSortHelper(int left, int right);
-    void heapify(int n, int i);
+    // 选择算法：partialSort/topK 的 k 为元素个数，nthElement 的 k 为目标位置（从 0 计）。
+    // topK 不改变 data，结果（升序）见 getSelection
+    void partialSort(size_t k);
+    void nthElement(size_t k);
+    void topK(size_t k);
+    void select(SelectionAlgorithm algorithm, size_t k);
+    const std::vector<int>& getSelection() const { return selection; }
     
-    // 性能测试
-    SortPerformance testAlgorithm(const std::string& algorithmName, void (SortingSystem::*sortFunc)());
+    // 性能测试：重复计时直到 kMaxTrials 次或累计超过 kTrialTimeBudgetMs（慢算法只跑一次），
+    // timeTaken 取中位数；完整的统计基准测试见 benchmark.h
+    static constexpr size_t kMaxTrials = 7;
+    static constexpr double kTrialTimeBudgetMs = 300.0;
+    SortPerformance testAlgorithm(const std::string& algorithmName, SortAlgorithm algorithm);
+    SortPerformance testSelection(const std::string& algorithmName, SelectionAlgorithm algorithm, size_t k);
+    const PerfCounterGroup& getPerfCounters();
+    size_t getComparisons() const { return lastStats.comparisons; }
+    size_t getSwaps() const { return lastStats.swaps; }
+    size_t getAllocations() const { return lastStats.allocations; }
+    size_t getPasses() const { return lastStats.passes; }
+    size_t getBytesMoved() const { return lastStats.bytesMoved; }
+
+    // 并行线程数（0 表示使用硬件并发数）
+    void setThreadCount(size_t count);
+    size_t getThreadCount() const { return threadCount; }
 
     // 工具函数
     bool isSorted() const;
     void printData() const;
     static std::vector<int> generateTestData(size_t size, DataPattern pattern);
-
-private:
-    // 排序过程中的交换操作（用于统计）
-    void swap(int& a, int& b);
+    // 固定种子，相同参数总是生成相同的数据（可复现的基准测试）；
+    // 给出 pool 时并行生成，结果与线程数无关（见 data_generator.h）
+    static std::vector<int> generateTestData(size_t size, DataPattern pattern, uint64_t seed, ThreadPool* pool = nullptr,
+                                             const PatternParams& params = PatternParams());
 };
 
 #endif // SORTING_SYSTEM_H
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <vector>
+#include "data_generator.h"
+#include "frame_renderer.h"
+#include "test_check.h"
+
+namespace {
+
+using Scheduler = ReplayScheduler<ManualReplayClock>;
+
+// 第 x 列依赖的下标区间，与 BarChartRenderer 的划分相同：[x·n/w, (x+1)·n/w)，至少一个元素
+std::pair<size_t, size_t> columnIndices(int x, size_t count, int width) {
+    size_t lo = static_cast<size_t>(x) * count / static_cast<size_t>(width);
+    size_t hi = static_cast<size_t>(x + 1) * count / static_cast<size_t>(width);
+    return {lo, std::max(hi, lo + 1)};
+}
+
+// 逐列枚举：依赖 [begin, end) 中任一下标的列必须恰好组成 barColumnsOf 返回的区间
+void testBarColumnsMatchesBruteForce() {
+    for (size_t count : {1u, 2u, 3u, 7u, 64u, 99u, 100u, 101u, 333u, 1000u, 4096u}) {
+        for (int width : {1, 2, 3, 50, 64, 100, 127, 640}) {
+            for (size_t begin = 0; begin < count; begin += std::max<size_t>(1, count / 37)) {
+                for (size_t end : {begin + 1, begin + 2, begin + 5, std::min(count, begin + count / 3 + 1)}) {
+                    if (end <= begin) continue;
+                    int first = width, last = 0;
+                    for (int x = 0; x < width; x++) {
+                        auto [lo, hi] = columnIndices(x, count, width);
+                        if (lo < std::min(end, count) && begin < hi) {
+                            first = std::min(first, x);
+                            last = x + 1;
+                        }
+                    }
+                    auto columns = barColumnsOf(begin, end, count, width);
+                    CHECK_EQ(columns.first, first);
+                    CHECK_EQ(columns.second, last);
+                }
+            }
+        }
+    }
+
+    // 空区间、越界与零宽画布
+    CHECK(barColumnsOf(5, 5, 10, 100) == std::make_pair(0, 0));
+    CHECK(barColumnsOf(10, 12, 10, 100) == std::make_pair(0, 0));
+    CHECK(barColumnsOf(0, 1, 10, 0) == std::make_pair(0, 0));
+    CHECK(barColumnsOf(0, 1, 0, 100) == std::make_pair(0, 0));
+    CHECK(barColumnsOf(8, 20, 10, 100) == barColumnsOf(8, 10, 10, 100));
+    CHECK(barColumnsOf(0, 10, 10, 100) == std::make_pair(0, 100));
+}
+
+bool sameFrame(const Framebuffer& a, const Framebuffer& b) {
+    std::span<const Rgba> x = a.data(), y = b.data();
+    return a.width() == b.width() && a.height() == b.height() && std::equal(x.begin(), x.end(), y.begin(), y.end());
+}
+
+// 按回放帧比较：每一帧只重画脏列的结果都必须与整帧重画逐像素相同
+void checkReplayMatchesFullRender(SortAlgorithm algorithm, size_t count, int width, int height, double speed) {
+    std::vector<int> input = generatePatternData<int>(count, DataPattern::Random, PatternParams(), count);
+    SortTrace trace = recordSortTrace(algorithm, input);
+    BarValueRange range = barValueRange(trace.initial);
+    TraceReplayer replayer(trace);
+    Scheduler scheduler(60.0, speed);
+    scheduler.start();
+
+    Framebuffer fullFrame(width, height), incrementalFrame(width, height);
+    BarChartRenderer fullRenderer, incrementalRenderer;
+    ReplayFrame frame;
+    // 第一次调用时整帧绘制
+    const DirtyRanges& initial = incrementalRenderer.renderDirty(incrementalFrame, replayer.values(), range,
+                                                                 frame.dirty);
+    CHECK_EQ(initial.count(), static_cast<size_t>(width));
+
+    size_t frames = 0, mismatches = 0, partialFrames = 0;
+    while (!frame.finished && frames < 2000) {
+        scheduler.getClock().advance(scheduler.untilNextFrame());
+        scheduler.nextFrame(replayer, frame);
+        fullRenderer.render(fullFrame, replayer.values(), range, frame.highlight1, frame.highlight2);
+        const DirtyRanges& columns = incrementalRenderer.renderDirty(incrementalFrame, replayer.values(), range,
+                                                                     frame.dirty, frame.highlight1, frame.highlight2);
+        if (!sameFrame(fullFrame, incrementalFrame)) mismatches++;
+        if (columns.count() < static_cast<size_t>(width)) partialFrames++;
+        CHECK(frame.dirty.empty() || !columns.empty());
+        frames++;
+    }
+    CHECK(frame.finished);
+    CHECK_EQ(mismatches, size_t{0});
+    // 增量绘制确实只画了一部分列（否则上面的比较没有意义）
+    CHECK(partialFrames > 0);
+    std::span<const int> values = replayer.values();
+    CHECK(std::is_sorted(values.begin(), values.end()));
+}
+
+void testRenderDirtyMatchesFullRender() {
+    // 元素少于列（带间隔与不带间隔）、与列数相同、多于列（一列聚合多个元素）
+    checkReplayMatchesFullRender(SortAlgorithm::InsertionSort, 20, 160, 40, 2.0);
+    checkReplayMatchesFullRender(SortAlgorithm::QuickSort, 100, 160, 40, 5.0);
+    checkReplayMatchesFullRender(SortAlgorithm::HeapSort, 160, 160, 40, 20.0);
+    checkReplayMatchesFullRender(SortAlgorithm::MergeSort, 1000, 160, 40, 50.0);
+    checkReplayMatchesFullRender(SortAlgorithm::PdqSort, 5000, 127, 33, 500.0);
+    checkReplayMatchesFullRender(SortAlgorithm::RadixSortLSD, 3000, 160, 40, 10.0);
+}
+
+// 画布、元素个数或取值范围变化，以及 invalidate() 之后整帧重画
+void testFullRedrawTriggers() {
+    std::vector<int> values = {5, 3, 9, 1, 7, 2, 8, 4};
+    BarValueRange range = barValueRange(values);
+    DirtyRanges none;
+    Framebuffer frame(64, 16), other(64, 16), reference(64, 16);
+    BarChartRenderer renderer, referenceRenderer;
+
+    CHECK_EQ(renderer.renderDirty(frame, values, range, none).count(), size_t{64});
+    CHECK(renderer.renderDirty(frame, values, range, none).empty());
+
+    renderer.invalidate();
+    CHECK_EQ(renderer.renderDirty(frame, values, range, none).count(), size_t{64});
+
+    // 换一块画布
+    CHECK_EQ(renderer.renderDirty(other, values, range, none).count(), size_t{64});
+    // 尺寸变化
+    frame.resize(80, 16);
+    CHECK_EQ(renderer.renderDirty(frame, values, range, none).count(), size_t{80});
+    // 取值范围变化
+    values[2] = 20;
+    range = barValueRange(values);
+    CHECK_EQ(renderer.renderDirty(frame, values, range, none).count(), size_t{80});
+    // 元素个数变化
+    values.push_back(6);
+    CHECK_EQ(renderer.renderDirty(frame, values, range, none).count(), size_t{80});
+
+    // 改一个值、只标记这一个下标：只重画它的列，结果与整帧重画相同
+    values[4] = 0;
+    DirtyRanges dirty;
+    dirty.mark(4);
+    const DirtyRanges& columns = renderer.renderDirty(frame, values, range, dirty);
+    auto expected = barColumnsOf(4, 5, values.size(), 80);
+    CHECK_EQ(columns.ranges().size(), size_t{1});
+    CHECK_EQ(columns.ranges()[0].begin, static_cast<size_t>(expected.first));
+    CHECK_EQ(columns.ranges()[0].end, static_cast<size_t>(expected.second));
+    reference.resize(80, 16);
+    referenceRenderer.render(reference, values, range);
+    CHECK(sameFrame(frame, reference));
+
+    // 换配色后整帧重画
+    BarChartStyle style;
+    style.bar = makeRgba(10, 20, 30);
+    renderer.setStyle(style);
+    referenceRenderer.setStyle(style);
+    CHECK_EQ(renderer.renderDirty(frame, values, range, none).count(), size_t{80});
+    referenceRenderer.render(reference, values, range);
+    CHECK(sameFrame(frame, reference));
+}
+
+} // namespace
+
+int main() {
+    testBarColumnsMatchesBruteForce();
+    testRenderDirtyMatchesFullRender();
+    testFullRedrawTriggers();
+    return testFailures();
+}
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "replay_scheduler.h"
+#include "test_check.h"
+
+namespace {
+
+using Scheduler = ReplayScheduler<ManualReplayClock>;
+
+// n 个元素、events 个 Write 事件（依次写第 i % n 个元素）
+SortTrace makeWriteTrace(size_t n, size_t events) {
+    SortTrace trace;
+    trace.initial.assign(n, 0);
+    for (size_t i = 0; i < events; i++) {
+        trace.events.push({SortEvent::Type::Write, static_cast<uint32_t>(i % n), kTraceTempIndex,
+                           static_cast<int32_t>(i)});
+    }
+    return trace;
+}
+
+bool covers(const DirtyRanges& dirty, size_t index) {
+    for (const DirtyRanges::Range& r : dirty.ranges()) {
+        if (r.begin <= index && index < r.end) return true;
+    }
+    return false;
+}
+
+// 区间有序、非空且互不相邻
+bool isNormalized(const DirtyRanges& dirty) {
+    std::span<const DirtyRanges::Range> ranges = dirty.ranges();
+    for (size_t i = 0; i < ranges.size(); i++) {
+        if (ranges[i].begin >= ranges[i].end) return false;
+        if (i > 0 && ranges[i - 1].end >= ranges[i].begin) return false;
+    }
+    return true;
+}
+
+// 128 fps 的帧间隔为 2^-7 秒，速度 0.2 时每帧 1.5625 个事件，配额的累加没有舍入误差
+void testFrameBudgetCarriesFraction() {
+    SortTrace trace = makeWriteTrace(16, 1000);
+    TraceReplayer replayer(trace);
+    Scheduler scheduler(128.0, 0.2);
+    CHECK_EQ(scheduler.frameInterval().count(), 7812500);
+    scheduler.start();
+
+    ReplayFrame frame;
+    size_t total = 0;
+    for (int k = 1; k <= 64; k++) {
+        CHECK_EQ(scheduler.untilNextFrame().count(), 7812500);
+        scheduler.getClock().advance(scheduler.untilNextFrame());
+        CHECK(scheduler.nextFrame(replayer, frame));
+        // 每帧只能取整，余下的小数留给下一帧：累计事件数始终为 floor(k × 1.5625)
+        CHECK(frame.events == 1 || frame.events == 2);
+        total += frame.events;
+        CHECK_EQ(total, static_cast<size_t>(std::floor(k * 1.5625)));
+        CHECK_EQ(frame.position, total);
+        CHECK_EQ(replayer.position(), total);
+    }
+    CHECK_EQ(total, size_t{100});
+}
+
+// 两帧间隔再长，也最多补 kMaxCatchUpFrames 帧的事件
+void testCatchUpIsCapped() {
+    SortTrace trace = makeWriteTrace(16, 10000);
+    TraceReplayer replayer(trace);
+    Scheduler scheduler(128.0, 1.0); // 每帧 7.8125 个事件
+    scheduler.start();
+
+    ReplayFrame frame;
+    scheduler.getClock().advance(scheduler.frameInterval() * 100);
+    scheduler.nextFrame(replayer, frame);
+    CHECK_EQ(frame.events, static_cast<size_t>(7.8125 * Scheduler::kMaxCatchUpFrames));
+    // 错过的帧直接跳过：下一帧仍在一个间隔之后，而不是立刻到期
+    CHECK_EQ(scheduler.untilNextFrame().count(), scheduler.frameInterval().count());
+
+    scheduler.getClock().advance(scheduler.untilNextFrame());
+    scheduler.nextFrame(replayer, frame);
+    CHECK_EQ(frame.events, size_t{8}); // 31.25 余下的 0.25 + 7.8125
+}
+
+// 暂停期间不积累配额，恢复后从恢复时刻重新计时；暂停前剩下的小数配额保留
+void testPauseBuildsNoCredit() {
+    SortTrace trace = makeWriteTrace(16, 10000);
+    TraceReplayer replayer(trace);
+    Scheduler scheduler(128.0, 1.0);
+    scheduler.start();
+
+    ReplayFrame frame;
+    scheduler.getClock().advance(scheduler.untilNextFrame());
+    scheduler.nextFrame(replayer, frame);
+    CHECK_EQ(frame.events, size_t{7}); // 余 0.8125
+
+    scheduler.pause();
+    CHECK(scheduler.isPaused());
+    for (int i = 0; i < 50; i++) {
+        scheduler.getClock().advance(scheduler.frameInterval());
+        CHECK(!scheduler.nextFrame(replayer, frame));
+        CHECK_EQ(frame.events, size_t{0});
+        CHECK(frame.dirty.empty());
+    }
+    CHECK_EQ(replayer.position(), size_t{7});
+
+    // 恢复前再等一段时间也不计入
+    scheduler.getClock().advance(scheduler.frameInterval() * 10);
+    scheduler.resume();
+    CHECK(!scheduler.isPaused());
+    CHECK_EQ(scheduler.untilNextFrame().count(), scheduler.frameInterval().count());
+    scheduler.getClock().advance(scheduler.untilNextFrame());
+    scheduler.nextFrame(replayer, frame);
+    CHECK_EQ(frame.events, size_t{8}); // 0.8125 + 7.8125
+}
+
+void testDirtyRangesMerge() {
+    DirtyRanges dirty;
+    CHECK(dirty.empty());
+    dirty.mark(5);
+    dirty.mark(6); // 相邻
+    CHECK_EQ(dirty.ranges().size(), size_t{1});
+    CHECK_EQ(dirty.ranges()[0].begin, size_t{5});
+    CHECK_EQ(dirty.ranges()[0].end, size_t{7});
+
+    dirty.mark(3, 5); // 与左侧相邻
+    dirty.mark(10, 12);
+    dirty.mark(11, 15); // 重叠
+    dirty.mark(20);
+    CHECK_EQ(dirty.ranges().size(), size_t{3});
+    CHECK_EQ(dirty.ranges()[0].begin, size_t{3});
+    CHECK_EQ(dirty.ranges()[0].end, size_t{7});
+    CHECK_EQ(dirty.ranges()[1].begin, size_t{10});
+    CHECK_EQ(dirty.ranges()[1].end, size_t{15});
+    CHECK_EQ(dirty.count(), size_t{10});
+
+    dirty.mark(6, 21); // 吞并后面的所有区间
+    CHECK_EQ(dirty.ranges().size(), size_t{1});
+    CHECK_EQ(dirty.ranges()[0].begin, size_t{3});
+    CHECK_EQ(dirty.ranges()[0].end, size_t{21});
+
+    dirty.mark(4, 4); // 空区间不改变结果
+    CHECK_EQ(dirty.count(), size_t{18});
+
+    dirty.clear();
+    CHECK(dirty.empty());
+    CHECK_EQ(dirty.count(), size_t{0});
+}
+
+// 超出上限时合并间隔最小的相邻两段
+void testDirtyRangesOverflowMergesSmallestGap() {
+    DirtyRanges dirty(3);
+    dirty.mark(0);
+    dirty.mark(10);
+    dirty.mark(13);
+    dirty.mark(30); // 间隔 9、2、16：合并 [10, 11) 与 [13, 14)
+    CHECK_EQ(dirty.ranges().size(), size_t{3});
+    CHECK_EQ(dirty.ranges()[0].end, size_t{1});
+    CHECK_EQ(dirty.ranges()[1].begin, size_t{10});
+    CHECK_EQ(dirty.ranges()[1].end, size_t{14});
+    CHECK_EQ(dirty.ranges()[2].begin, size_t{30});
+
+    // 随机标记：区间数不超过上限，且每个标记过的下标都被覆盖
+    std::mt19937_64 rng(12345);
+    for (size_t maxRanges : {1u, 2u, 4u, 16u}) {
+        for (int round = 0; round < 200; round++) {
+            DirtyRanges ranges(maxRanges);
+            std::vector<size_t> marked;
+            size_t marks = rng() % 64 + 1;
+            for (size_t m = 0; m < marks; m++) {
+                size_t begin = rng() % 1000;
+                size_t end = begin + rng() % 4 + 1;
+                ranges.mark(begin, end);
+                for (size_t i = begin; i < end; i++) marked.push_back(i);
+                CHECK(ranges.ranges().size() <= maxRanges);
+                CHECK(isNormalized(ranges));
+            }
+            for (size_t i : marked) CHECK(covers(ranges, i));
+        }
+    }
+}
+
+// 回放结束后多出一帧清除高亮，之后不再需要重绘
+void testFinishClearsHighlight() {
+    SortTrace trace;
+    trace.initial = {7, 6, 5, 4, 3, 2, 1, 0};
+    trace.events.push({SortEvent::Type::Compare, 0, 1, 0});
+    trace.events.push({SortEvent::Type::Swap, 1, 2, 0});
+    trace.events.push({SortEvent::Type::Write, 5, kTraceTempIndex, 42});
+    trace.events.push({SortEvent::Type::Move, 3, 4, 0});
+    TraceReplayer replayer(trace);
+    Scheduler scheduler(128.0, 100.0);
+    scheduler.start();
+
+    ReplayFrame frame;
+    scheduler.getClock().advance(scheduler.untilNextFrame());
+    CHECK(scheduler.nextFrame(replayer, frame));
+    CHECK_EQ(frame.events, size_t{4});
+    CHECK(frame.finished);
+    CHECK_EQ(frame.position, size_t{4});
+    CHECK_EQ(frame.highlight1, 3);
+    CHECK_EQ(frame.highlight2, 4);
+    for (size_t i : {1u, 2u, 3u, 4u, 5u}) CHECK(covers(frame.dirty, i));
+    CHECK(!covers(frame.dirty, 0));
+    std::vector<int> expected = {7, 5, 6, 3, 3, 42, 1, 0};
+    CHECK(std::equal(expected.begin(), expected.end(), replayer.values().begin(), replayer.values().end()));
+
+    scheduler.getClock().advance(scheduler.untilNextFrame());
+    CHECK(scheduler.nextFrame(replayer, frame));
+    CHECK_EQ(frame.events, size_t{0});
+    CHECK(frame.finished);
+    CHECK_EQ(frame.highlight1, -1);
+    CHECK_EQ(frame.highlight2, -1);
+    CHECK_EQ(frame.dirty.count(), size_t{2}); // 上一帧高亮的两列
+    CHECK(covers(frame.dirty, 3));
+    CHECK(covers(frame.dirty, 4));
+
+    scheduler.getClock().advance(scheduler.untilNextFrame());
+    CHECK(!scheduler.nextFrame(replayer, frame));
+    CHECK(frame.dirty.empty());
+    CHECK(frame.finished);
+}
+
+// 与暂存值比较（下标 -1）时不高亮、不标脏
+void testTempIndexIsNotHighlighted() {
+    SortTrace trace;
+    trace.initial = {1, 2, 3};
+    trace.events.push({SortEvent::Type::Compare, kTraceTempIndex, 2, 0});
+    TraceReplayer replayer(trace);
+    Scheduler scheduler(128.0, 100.0);
+    scheduler.start();
+
+    ReplayFrame frame;
+    scheduler.getClock().advance(scheduler.untilNextFrame());
+    CHECK(scheduler.nextFrame(replayer, frame));
+    CHECK_EQ(frame.highlight1, -1);
+    CHECK_EQ(frame.highlight2, 2);
+    CHECK_EQ(frame.dirty.count(), size_t{1});
+    CHECK(covers(frame.dirty, 2));
+}
+
+} // namespace
+
+int main() {
+    testFrameBudgetCarriesFraction();
+    testCatchUpIsCapped();
+    testPauseBuildsNoCredit();
+    testDirtyRangesMerge();
+    testDirtyRangesOverflowMergesSmallestGap();
+    testFinishClearsHighlight();
+    testTempIndexIsNotHighlighted();
+    return testFailures();
+}
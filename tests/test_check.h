@@ -0,0 +1,33 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+
+// 极简断言：失败时打印位置与表达式并计数，不中断后续检查。
+// 测试的 main 返回 testFailures()，ctest 以非零退出码判定失败
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                             \
+    do {                                                                                             \
+        if (!(condition)) {                                                                          \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK(" #condition ") 失败" << std::endl;   \
+            testFailures()++;                                                                        \
+        }                                                                                            \
+    } while (false)
+
+#define CHECK_EQ(actual, expected)                                                                   \
+    do {                                                                                             \
+        const auto& checkActual = (actual);                                                          \
+        const auto& checkExpected = (expected);                                                      \
+        if (!(checkActual == checkExpected)) {                                                       \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK_EQ(" #actual ", " #expected         \
+                      << ") 失败: " << checkActual << " != " << checkExpected << std::endl;            \
+            testFailures()++;                                                                        \
+        }                                                                                            \
+    } while (false)
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include "data_generator.h"
+#include "trace_file.h"
+#include "test_check.h"
+
+namespace {
+
+std::string tempTracePath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("trace_file_test_" + name + ".trace")).string();
+}
+
+bool sameValues(std::span<const int> a, std::span<const int> b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+// 逐步读取与前后任意定位都要与内存中的 TraceReplayer 一致
+void checkMatchesReplayer(const SortTrace& trace, const std::string& path, uint32_t keyframeInterval) {
+    TraceFileReader reader(path);
+    CHECK_EQ(reader.size(), static_cast<uint64_t>(trace.events.size()));
+    CHECK_EQ(reader.header().elementCount, static_cast<uint64_t>(trace.initial.size()));
+    CHECK_EQ(reader.header().keyframeInterval, keyframeInterval);
+    CHECK(sameValues(reader.values(), trace.initial));
+
+    TraceReplayer replayer(trace);
+    while (!replayer.done()) {
+        const TraceEvent& expected = replayer.step();
+        const TraceEvent& actual = reader.step();
+        CHECK(actual.type == expected.type);
+        CHECK_EQ(actual.first, expected.first);
+        CHECK_EQ(actual.second, expected.second);
+        if (expected.type == SortEvent::Type::Write) CHECK_EQ(actual.value, expected.value);
+    }
+    CHECK(reader.done());
+    CHECK(sameValues(reader.values(), replayer.values()));
+
+    // 关键帧边界两侧、两端、越界以及随机的前后跳转
+    std::vector<uint64_t> targets = {0, 1, trace.events.size(), trace.events.size() + 10, 0};
+    for (uint64_t k = keyframeInterval; k <= trace.events.size(); k += keyframeInterval) {
+        targets.insert(targets.end(), {k - 1, k, k + 1});
+    }
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 200; i++) targets.push_back(rng() % (trace.events.size() + 1));
+
+    for (uint64_t target : targets) {
+        reader.seek(target);
+        replayer.seek(std::min<size_t>(target, trace.events.size()));
+        CHECK_EQ(reader.position(), static_cast<uint64_t>(replayer.position()));
+        CHECK(sameValues(reader.values(), replayer.values()));
+    }
+}
+
+// 边排序边写的文件与内存记录的事件完全相同，回放到末尾即为排序结果
+void testRecordedFileMatchesTrace() {
+    std::vector<int> input = generatePatternData<int>(600, DataPattern::Random, PatternParams(), 42);
+    const uint32_t keyframeInterval = 257;
+    for (SortAlgorithm algorithm : {SortAlgorithm::InsertionSort, SortAlgorithm::QuickSort, SortAlgorithm::MergeSort,
+                                    SortAlgorithm::HeapSort, SortAlgorithm::PdqSort, SortAlgorithm::RadixSortLSD}) {
+        std::string path = tempTracePath(std::to_string(static_cast<int>(algorithm)));
+        SortTrace trace = recordSortTrace(algorithm, input);
+        TraceFileHeader header = recordSortTraceFile(algorithm, input, path, keyframeInterval);
+        CHECK_EQ(header.eventCount, static_cast<uint64_t>(trace.events.size()));
+        CHECK_EQ(header.comparisons, static_cast<uint64_t>(trace.comparisons));
+        // 关键帧在第 0、I、2I…… 个事件之前写出
+        uint64_t keyframes = (header.eventCount + keyframeInterval - 1) / keyframeInterval;
+        CHECK_EQ(header.keyframeCount, std::max<uint64_t>(keyframes, 1));
+        checkMatchesReplayer(trace, path, keyframeInterval);
+
+        TraceFileReader reader(path);
+        CHECK(reader.algorithm() == algorithm);
+        reader.seek(reader.size());
+        std::span<const int> values = reader.values();
+        CHECK(std::is_sorted(values.begin(), values.end()));
+        std::filesystem::remove(path);
+    }
+}
+
+// 手工构造的事件：暂存下标、负数与极值写入、下标大幅跳动，覆盖各种增量编码
+void testEncodingEdgeCases() {
+    SortTrace trace;
+    trace.initial = {0, -1, 2147483647, -2147483647 - 1, 5, 100000, -100000, 7, 8, 9};
+    for (int round = 0; round < 40; round++) {
+        trace.events.push({SortEvent::Type::Compare, kTraceTempIndex, 9, 0});
+        trace.events.push({SortEvent::Type::Compare, 9, kTraceTempIndex, 0});
+        trace.events.push({SortEvent::Type::Swap, 0, 9, 0});
+        trace.events.push({SortEvent::Type::Swap, 9, 0, 0});
+        trace.events.push({SortEvent::Type::Move, 3, 2, 0});
+        trace.events.push({SortEvent::Type::Write, 2, kTraceTempIndex, -2147483647 - 1});
+        trace.events.push({SortEvent::Type::Write, 8, kTraceTempIndex, 2147483647});
+        trace.events.push({SortEvent::Type::Write, 1, kTraceTempIndex, round * 1000 - 20000});
+    }
+    std::string path = tempTracePath("edge");
+    for (uint32_t keyframeInterval : {1u, 3u, 8u, 1000u}) {
+        writeTraceFile(path, trace, keyframeInterval);
+        checkMatchesReplayer(trace, path, keyframeInterval);
+    }
+    std::filesystem::remove(path);
+
+    // 没有事件时只有初始关键帧
+    SortTrace empty;
+    empty.initial = {3, 1, 2};
+    writeTraceFile(path, empty, 4);
+    TraceFileReader reader(path);
+    CHECK_EQ(reader.size(), uint64_t{0});
+    CHECK(reader.done());
+    reader.seek(5);
+    CHECK_EQ(reader.position(), uint64_t{0});
+    CHECK(sameValues(reader.values(), empty.initial));
+    std::filesystem::remove(path);
+}
+
+// 未 finish 的写入器析构时删除临时文件，目标文件不会出现
+void testUnfinishedWriterLeavesNothing() {
+    std::string path = tempTracePath("unfinished");
+    std::filesystem::remove(path);
+    std::vector<int> initial = {1, 2, 3};
+    {
+        TraceFileWriter writer(path, SortAlgorithm::BubbleSort, initial, 2);
+        writer.append({SortEvent::Type::Swap, 0, 1, 0});
+    }
+    CHECK(!std::filesystem::exists(path));
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    std::string prefix = std::filesystem::path(path).filename().string() + ".";
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        CHECK(!entry.path().filename().string().starts_with(prefix));
+    }
+}
+
+} // namespace
+
+int main() {
+    testRecordedFileMatchesTrace();
+    testEncodingEdgeCases();
+    testUnfinishedWriterLeavesNothing();
+    return testFailures();
+}
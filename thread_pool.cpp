@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+// 当前线程所属的线程池及其队列下标（非工作线程为 nullptr）
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t workerCount = threadCount - 1;
+
+    for (size_t i = 0; i <= workerCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lg(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::currentQueueIndex() const {
+    return currentPool == this ? currentIndex : queues.size() - 1;
+}
+
+void ThreadPool::submit(Task task) {
+    WorkQueue& queue = *queues[currentQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lg(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    pendingTasks++;
+    {
+        // 与 workerLoop 中的条件检查同步，避免丢失唤醒
+        std::lock_guard<std::mutex> lg(sleepMutex);
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::popTask(size_t index, Task& task) {
+    WorkQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lg(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::stealTask(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue& queue = *queues[(thief + offset) % queues.size()];
+        std::lock_guard<std::mutex> lg(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    if (pendingTasks == 0) return false;
+
+    size_t index = currentQueueIndex();
+    Task task;
+    if (!popTask(index, task) && !stealTask(index, task)) return false;
+
+    pendingTasks--;
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        if (runPendingTask()) continue;
+
+        std::unique_lock<std::mutex> lk(sleepMutex);
+        wakeUp.wait(lk, [this]() { return stopping || pendingTasks > 0; });
+        if (stopping) return;
+    }
+}
+
+void TaskGroup::run(std::function<void()> fn) {
+    pending++;
+    pool.submit([this, fn = std::move(fn)]() {
+        fn();
+        pending--;
+    });
+}
+
+void TaskGroup::wait() {
+    while (pending > 0) {
+        if (!pool.runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 可复用的工作窃取线程池
+// 每个工作线程拥有自己的任务双端队列：本线程从队尾取任务（后进先出，缓存友好），
+// 空闲线程从其他队列的队首窃取（先进先出，窃取到的通常是较大的任务）。
+// 非工作线程提交的任务进入共享的外部队列。
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount 为总并发度（包含在 TaskGroup::wait 中协助执行任务的调用线程），
+    // 因此实际创建 threadCount - 1 个工作线程；0 表示使用硬件并发数
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getThreadCount() const { return workers.size() + 1; }
+
+    void submit(Task task);
+
+    // 取出（或窃取）一个待执行任务并在当前线程运行；没有任务时返回 false
+    bool runPendingTask();
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues; // 最后一个为外部队列
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pendingTasks{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+
+    void workerLoop(size_t index);
+    size_t currentQueueIndex() const;
+    bool popTask(size_t index, Task& task);
+    bool stealTask(size_t thief, Task& task);
+};
+
+// fork-join 任务组：run() 提交子任务，wait() 等待全部完成，
+// 等待期间调用线程会执行池中的其他任务，嵌套使用不会死锁
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> fn);
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::atomic<size_t> pending{0};
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,302 @@
+#include "trace_file.h"
+#include "data_generator.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr size_t kFlushBytes = size_t(1) << 20;
+constexpr uint8_t kFirstTempBit = 1 << 2;
+constexpr uint8_t kSecondTempBit = 1 << 3;
+constexpr uint64_t kInlineDeltaLimit = 15; // 首字节高 4 位能内联的最大增量（15 表示后跟 varint）
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t getVarint(const std::vector<uint8_t>& in, size_t& pos) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) throw std::runtime_error("追踪文件数据块不完整");
+        uint8_t byte = in[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("追踪文件中的 varint 过长");
+}
+
+// 追踪文件可能超过 2 GiB，不能用 long 偏移的 fseek
+bool seekTo(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+void applyEvent(std::vector<int>& values, const TraceEvent& event) {
+    switch (event.type) {
+        case SortEvent::Type::Compare: break;
+        case SortEvent::Type::Swap: std::swap(values[event.first], values[event.second]); break;
+        case SortEvent::Type::Move: values[event.first] = values[event.second]; break;
+        case SortEvent::Type::Write: values[event.first] = event.value; break;
+    }
+}
+
+} // namespace
+
+void TraceFileCloser::operator()(std::FILE* file) const {
+    if (file) std::fclose(file);
+}
+
+uint32_t defaultKeyframeInterval(size_t elementCount) {
+    return static_cast<uint32_t>(std::clamp<size_t>(elementCount * 4, size_t(1) << 16, size_t(1) << 31));
+}
+
+// 临时文件与目标同目录（rename 才是原子的），文件名带随机标记（同 ExternalSorter::tempPath），
+// 同时录制到同一目标的两个 writer 不会互相覆盖临时文件
+TraceFileWriter::TraceFileWriter(const std::string& path, SortAlgorithm algorithm, std::span<const int> initial,
+                                 uint32_t keyframeInterval)
+    : path(path), tempPath(path + "." + std::to_string(randomSeed()) + ".tmp"), mirror(initial.begin(), initial.end()) {
+    file.reset(std::fopen(tempPath.c_str(), "wb"));
+    if (!file) throw std::runtime_error("无法创建文件: " + tempPath);
+
+    std::memcpy(header.magic, TraceFileHeader::kMagic, sizeof(header.magic));
+    header.version = TraceFileHeader::kVersion;
+    header.algorithm = static_cast<uint32_t>(algorithm);
+    header.elementCount = mirror.size();
+    header.keyframeInterval = keyframeInterval ? keyframeInterval : defaultKeyframeInterval(mirror.size());
+
+    // 先占位，finish() 时回填
+    pending.resize(sizeof(TraceFileHeader));
+    writeKeyframe();
+}
+
+TraceFileWriter::~TraceFileWriter() {
+    if (!finished) {
+        file.reset();
+        std::error_code ignored;
+        std::filesystem::remove(tempPath, ignored);
+    }
+}
+
+void TraceFileWriter::writeKeyframe() {
+    index.push_back({events, bytesWritten()});
+    previousFirst = 0;
+    previousValue = 0;
+    int32_t previous = 0;
+    for (int value : mirror) {
+        putVarint(pending, zigzag(static_cast<int64_t>(value) - previous));
+        previous = value;
+    }
+    nextKeyframe = events + header.keyframeInterval;
+}
+
+void TraceFileWriter::append(const TraceEvent& event) {
+    if (events == nextKeyframe) writeKeyframe();
+
+    bool firstTemp = event.first == kTraceTempIndex;
+    bool secondTemp = event.type != SortEvent::Type::Write && event.second == kTraceTempIndex;
+    uint8_t tag = static_cast<uint8_t>(event.type);
+    if (firstTemp) tag |= kFirstTempBit;
+    if (secondTemp) tag |= kSecondTempBit;
+
+    uint64_t firstDelta = 0;
+    if (!firstTemp) {
+        firstDelta = zigzag(static_cast<int64_t>(event.first) - previousFirst);
+        tag |= static_cast<uint8_t>(std::min(firstDelta, kInlineDeltaLimit) << 4);
+    }
+    pending.push_back(tag);
+    if (!firstTemp) {
+        if (firstDelta >= kInlineDeltaLimit) putVarint(pending, firstDelta - kInlineDeltaLimit);
+        previousFirst = event.first;
+    }
+    if (event.type == SortEvent::Type::Write) {
+        putVarint(pending, zigzag(static_cast<int64_t>(event.value) - previousValue));
+        previousValue = event.value;
+    } else if (!secondTemp) {
+        putVarint(pending, zigzag(static_cast<int64_t>(event.second) - previousFirst));
+    }
+
+    applyEvent(mirror, event);
+    events++;
+    if (pending.size() >= kFlushBytes) flush();
+}
+
+void TraceFileWriter::flush() {
+    if (pending.empty()) return;
+    if (std::fwrite(pending.data(), 1, pending.size(), file.get()) != pending.size()) {
+        throw std::runtime_error("写入文件失败: " + tempPath);
+    }
+    fileBytes += pending.size();
+    pending.clear();
+}
+
+void TraceFileWriter::finish(size_t comparisons, size_t swaps) {
+    header.eventCount = events;
+    header.keyframeCount = index.size();
+    header.indexOffset = bytesWritten();
+    header.comparisons = comparisons;
+    header.swaps = swaps;
+
+    const uint8_t* entries = reinterpret_cast<const uint8_t*>(index.data());
+    pending.insert(pending.end(), entries, entries + index.size() * sizeof(TraceKeyframeEntry));
+    flush();
+
+    bool ok = seekTo(file.get(), 0) &&
+              std::fwrite(&header, sizeof(header), 1, file.get()) == 1 && std::fflush(file.get()) == 0;
+    file.reset();
+    if (!ok) throw std::runtime_error("写入文件失败: " + tempPath);
+    std::filesystem::rename(tempPath, path);
+    finished = true;
+}
+
+TraceFileHeader recordSortTraceFile(SortAlgorithm algorithm, std::span<const int> input, const std::string& path,
+                                    uint32_t keyframeInterval) {
+    // 先于创建文件检查，避免留下只有文件头的 trace
+    if (isParallelSortAlgorithm(algorithm)) {
+        throw std::invalid_argument(std::string(sortAlgorithmName(algorithm)) + " 不支持记录事件");
+    }
+    TraceFileWriter writer(path, algorithm, input, keyframeInterval);
+    std::vector<int> work(input.begin(), input.end());
+    SortingEngine<int, std::less<int>, TraceFileRecorder> engine;
+    engine.getInstrumentation().writer = &writer;
+    engine.sort(algorithm, work);
+
+    // 基数排序不经过引擎钩子：补记与排序结果不同的位置
+    std::span<const int> replayed = writer.values();
+    for (size_t i = 0; i < work.size(); i++) {
+        if (replayed[i] != work[i]) {
+            writer.append({SortEvent::Type::Write, static_cast<uint32_t>(i), kTraceTempIndex, work[i]});
+        }
+    }
+    writer.finish(engine.getComparisons(), engine.getSwaps());
+    return writer.getHeader();
+}
+
+void writeTraceFile(const std::string& path, const SortTrace& trace, uint32_t keyframeInterval) {
+    TraceFileWriter writer(path, trace.algorithm, trace.initial, keyframeInterval);
+    for (size_t c = 0; c < trace.events.chunkCount(); c++) {
+        for (const TraceEvent& event : trace.events.chunk(c)) writer.append(event);
+    }
+    writer.finish(trace.comparisons, trace.swaps);
+}
+
+TraceFileReader::TraceFileReader(const std::string& path) : path(path) {
+    file.reset(std::fopen(path.c_str(), "rb"));
+    if (!file) throw std::runtime_error("无法打开文件: " + path);
+
+    uint64_t fileSize = std::filesystem::file_size(path);
+    if (std::fread(&fileHeader, sizeof(fileHeader), 1, file.get()) != 1 ||
+        std::memcmp(fileHeader.magic, TraceFileHeader::kMagic, sizeof(fileHeader.magic)) != 0) {
+        throw std::runtime_error("不是追踪文件: " + path);
+    }
+    if (fileHeader.version != TraceFileHeader::kVersion) {
+        throw std::runtime_error("不支持的追踪文件版本 " + std::to_string(fileHeader.version) + ": " + path);
+    }
+    if (fileHeader.algorithm >= kAllSortAlgorithms.size() || fileHeader.keyframeCount == 0 ||
+        fileHeader.indexOffset < sizeof(TraceFileHeader) || fileHeader.indexOffset > fileSize ||
+        (fileSize - fileHeader.indexOffset) != fileHeader.keyframeCount * sizeof(TraceKeyframeEntry)) {
+        throw std::runtime_error("追踪文件头部与文件长度不符: " + path);
+    }
+
+    index.resize(static_cast<size_t>(fileHeader.keyframeCount));
+    if (!seekTo(file.get(), fileHeader.indexOffset) ||
+        std::fread(index.data(), sizeof(TraceKeyframeEntry), index.size(), file.get()) != index.size()) {
+        throw std::runtime_error("读取追踪文件索引失败: " + path);
+    }
+    for (size_t k = 0; k < index.size(); k++) {
+        bool ordered = k == 0 ? index[k].position == 0 && index[k].offset == sizeof(TraceFileHeader)
+                              : index[k].position > index[k - 1].position && index[k].offset > index[k - 1].offset;
+        if (!ordered || index[k].offset > fileHeader.indexOffset || index[k].position > fileHeader.eventCount) {
+            throw std::runtime_error("追踪文件索引损坏: " + path);
+        }
+    }
+
+    current.resize(static_cast<size_t>(fileHeader.elementCount));
+    loadBlock(0);
+}
+
+void TraceFileReader::loadBlock(size_t k) {
+    uint64_t begin = index[k].offset;
+    uint64_t end = k + 1 < index.size() ? index[k + 1].offset : fileHeader.indexOffset;
+    block.resize(static_cast<size_t>(end - begin));
+    if (!seekTo(file.get(), begin) ||
+        std::fread(block.data(), 1, block.size(), file.get()) != block.size()) {
+        throw std::runtime_error("读取追踪文件失败: " + path);
+    }
+
+    blockCursor = 0;
+    int32_t previous = 0;
+    for (int& value : current) {
+        value = static_cast<int32_t>(previous + unzigzag(getVarint(block, blockCursor)));
+        previous = value;
+    }
+    currentBlock = k;
+    cursor = index[k].position;
+    previousFirst = 0;
+    previousValue = 0;
+}
+
+const TraceEvent& TraceFileReader::step() {
+    if (currentBlock + 1 < index.size() && cursor == index[currentBlock + 1].position) loadBlock(currentBlock + 1);
+    if (blockCursor >= block.size()) throw std::runtime_error("追踪文件数据块不完整: " + path);
+
+    uint8_t tag = block[blockCursor++];
+    TraceEvent event{static_cast<SortEvent::Type>(tag & 3), kTraceTempIndex, kTraceTempIndex, 0};
+    if (!(tag & kFirstTempBit)) {
+        uint64_t delta = tag >> 4;
+        if (delta == kInlineDeltaLimit) delta += getVarint(block, blockCursor);
+        event.first = static_cast<uint32_t>(previousFirst + unzigzag(delta));
+        previousFirst = event.first;
+    }
+    if (event.type == SortEvent::Type::Write) {
+        event.value = static_cast<int32_t>(previousValue + unzigzag(getVarint(block, blockCursor)));
+        previousValue = event.value;
+    } else if (!(tag & kSecondTempBit)) {
+        event.second = static_cast<uint32_t>(previousFirst + unzigzag(getVarint(block, blockCursor)));
+    }
+
+    bool inRange = (event.first == kTraceTempIndex ? event.type == SortEvent::Type::Compare : event.first < current.size()) &&
+                   (event.second == kTraceTempIndex ? event.type == SortEvent::Type::Compare || event.type == SortEvent::Type::Write
+                                                    : event.second < current.size());
+    if (!inRange) throw std::runtime_error("追踪文件中的事件下标越界: " + path);
+
+    applyEvent(current, event);
+    lastEvent = event;
+    cursor++;
+    return lastEvent;
+}
+
+uint64_t TraceFileReader::advance(uint64_t count) {
+    uint64_t applied = 0;
+    while (applied < count && !done()) {
+        step();
+        applied++;
+    }
+    return applied;
+}
+
+void TraceFileReader::seek(uint64_t target) {
+    target = std::min(target, fileHeader.eventCount);
+    auto next = std::upper_bound(index.begin(), index.end(), target,
+                                 [](uint64_t position, const TraceKeyframeEntry& entry) { return position < entry.position; });
+    size_t k = static_cast<size_t>(next - index.begin()) - 1;
+    if (k != currentBlock || target < cursor) loadBlock(k);
+    advance(target - cursor);
+}
@@ -0,0 +1,159 @@
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "sort_trace.h"
+
+// 压缩、可定位的排序追踪文件
+//   [0, 80)  TraceFileHeader（小端）
+//   块 0, 块 1, ...       每块 = 关键帧（此时的完整数组）+ 其后最多 keyframeInterval 个事件
+//   [indexOffset, ...)    keyframeCount 个 TraceKeyframeEntry {事件位置, 块偏移}
+// 关键帧中的值按与前一个值的差做 zigzag + varint 编码；事件首字节低 2 位为类型，
+// 第 2、3 位标记下标为暂存值，高 4 位内联较小的首下标增量，其余字段同样按增量 varint 编码
+// （首下标相对上一事件，第二下标相对首下标，写入值相对上一次写入值）。增量状态在每块开头清零，
+// 从任一关键帧都能独立解码，定位到第 p 步只需解码一个块。出错时抛出 std::runtime_error。
+
+struct TraceFileHeader {
+    static constexpr char kMagic[8] = {'S', 'O', 'R', 'T', 'T', 'R', 'A', 'C'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t algorithm;        // SortAlgorithm
+    uint64_t elementCount;
+    uint64_t eventCount;
+    uint64_t keyframeCount;
+    uint64_t indexOffset;
+    uint64_t comparisons;
+    uint64_t swaps;
+    uint32_t keyframeInterval; // 相邻关键帧之间的事件数
+    uint8_t reserved[12];
+};
+static_assert(sizeof(TraceFileHeader) == 80, "TraceFileHeader 必须为 80 字节");
+
+struct TraceKeyframeEntry {
+    uint64_t position; // 关键帧对应已应用的事件数
+    uint64_t offset;   // 块在文件中的偏移
+};
+
+struct TraceFileCloser {
+    void operator()(std::FILE* file) const;
+};
+
+// 关键帧间隔为 0 时取 max(4n, 65536)：关键帧的体积不超过事件数据的同一量级
+uint32_t defaultKeyframeInterval(size_t elementCount);
+
+// 边排序边写：事件先编码到内存缓冲区，攒满 1 MiB 再写入文件。写入器自己维护一份数组镜像，
+// 按事件更新，到达间隔时直接从镜像写出关键帧，不需要访问正在排序的数组。
+// 写入临时文件，finish() 后改名为 path；未 finish 就析构时删除临时文件
+class TraceFileWriter {
+public:
+    TraceFileWriter(const std::string& path, SortAlgorithm algorithm, std::span<const int> initial,
+                    uint32_t keyframeInterval = 0);
+    ~TraceFileWriter();
+
+    TraceFileWriter(const TraceFileWriter&) = delete;
+    TraceFileWriter& operator=(const TraceFileWriter&) = delete;
+
+    void append(const TraceEvent& event);
+    // 写出索引并回填头部
+    void finish(size_t comparisons, size_t swaps);
+
+    const TraceFileHeader& getHeader() const { return header; }
+    uint64_t eventCount() const { return events; }
+    uint64_t bytesWritten() const { return fileBytes + pending.size(); }
+    std::span<const int> values() const { return mirror; }
+
+private:
+    std::string path;
+    std::string tempPath;
+    std::unique_ptr<std::FILE, TraceFileCloser> file;
+    TraceFileHeader header{};
+    std::vector<TraceKeyframeEntry> index;
+    std::vector<uint8_t> pending;
+    std::vector<int> mirror;
+    uint64_t fileBytes = 0;
+    uint64_t events = 0;
+    uint64_t nextKeyframe = 0;
+    uint32_t previousFirst = 0;
+    int32_t previousValue = 0;
+    bool finished = false;
+
+    void writeKeyframe();
+    void flush();
+};
+
+// 插桩策略：事件直接交给 TraceFileWriter，不在内存中保留事件序列
+struct TraceFileRecorder : CountingInstrumentation {
+    TraceFileWriter* writer = nullptr;
+
+    void compare(std::ptrdiff_t i, std::ptrdiff_t j) {
+        CountingInstrumentation::compare(i, j);
+        writer->append({SortEvent::Type::Compare, TraceRecorder::traceIndex(i), TraceRecorder::traceIndex(j), 0});
+    }
+    void swap(std::ptrdiff_t i, std::ptrdiff_t j) {
+        CountingInstrumentation::swap(i, j);
+        writer->append({SortEvent::Type::Swap, TraceRecorder::traceIndex(i), TraceRecorder::traceIndex(j), 0});
+    }
+    void move(std::ptrdiff_t dst, std::ptrdiff_t src) {
+        CountingInstrumentation::move(dst, src);
+        writer->append({SortEvent::Type::Move, TraceRecorder::traceIndex(dst), TraceRecorder::traceIndex(src), 0});
+    }
+    template <typename V>
+    void write(std::ptrdiff_t k, const V& v) {
+        int32_t value = 0;
+        if constexpr (std::is_arithmetic_v<V>) value = static_cast<int32_t>(v);
+        writer->append({SortEvent::Type::Write, TraceRecorder::traceIndex(k), kTraceTempIndex, value});
+    }
+};
+
+// 以全速运行 algorithm，事件流式写入 path（基数排序与并行算法的处理同 recordSortTrace）；返回文件头部
+TraceFileHeader recordSortTraceFile(SortAlgorithm algorithm, std::span<const int> input, const std::string& path,
+                                    uint32_t keyframeInterval = 0);
+
+// 把内存中的追踪写成文件
+void writeTraceFile(const std::string& path, const SortTrace& trace, uint32_t keyframeInterval = 0);
+
+// 读取与定位：values() 为已应用前 position() 个事件后的数组。
+// 只在内存中保留索引和当前块；seek() 从不晚于目标的最近关键帧解码，前后拖动代价相同
+class TraceFileReader {
+public:
+    explicit TraceFileReader(const std::string& path);
+
+    const TraceFileHeader& header() const { return fileHeader; }
+    SortAlgorithm algorithm() const { return static_cast<SortAlgorithm>(fileHeader.algorithm); }
+    uint64_t size() const { return fileHeader.eventCount; }
+    uint64_t position() const { return cursor; }
+    bool done() const { return cursor >= fileHeader.eventCount; }
+    std::span<const int> values() const { return current; }
+
+    // 解码并应用下一个事件（调用前需确认 !done()）
+    const TraceEvent& step();
+    // 最多应用 count 个事件，返回实际应用的个数
+    uint64_t advance(uint64_t count);
+    void seek(uint64_t target);
+
+private:
+    std::string path;
+    std::unique_ptr<std::FILE, TraceFileCloser> file;
+    TraceFileHeader fileHeader{};
+    std::vector<TraceKeyframeEntry> index;
+    std::vector<uint8_t> block;
+    size_t blockCursor = 0;
+    size_t currentBlock = 0;
+    uint64_t cursor = 0;
+    std::vector<int> current;
+    TraceEvent lastEvent{};
+    uint32_t previousFirst = 0;
+    int32_t previousValue = 0;
+
+    void loadBlock(size_t k);
+};
+
+#endif // TRACE_FILE_H
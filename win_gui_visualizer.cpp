@@ -1,9 +1,14 @@
+// 排序引擎的头文件先于 <windows.h> 解析，不受 min/max 宏影响
+#include "sort_record.h"
+#include "sorting_engine.h"
+#include "sort_trace.h"
+#include "replay_scheduler.h"
 #include "win_gui_visualizer.h"
 #include <iostream>
 #include <algorithm>
-#include <random>
 #include <thread>
 #include <chrono>
+#include <cmath>
 #include <string>
 
 #include <uxtheme.h>
@@ -25,6 +30,27 @@ static void applyExplorerTheme(HWND h) {
 
 #ifdef _WIN32
 
+// 界面中的演示算法与 SortingEngine 中的经典实现一一对应
+static SortAlgorithm toEngineAlgorithm(SortingAlgorithm algorithm) {
+    switch (algorithm) {
+        case SortingAlgorithm::BubbleSort:    return SortAlgorithm::BubbleSort;
+        case SortingAlgorithm::QuickSort:     return SortAlgorithm::QuickSort;
+        case SortingAlgorithm::MergeSort:     return SortAlgorithm::MergeSort;
+        case SortingAlgorithm::HeapSort:      return SortAlgorithm::HeapSort;
+        case SortingAlgorithm::InsertionSort: return SortAlgorithm::InsertionSort;
+        case SortingAlgorithm::SelectionSort: return SortAlgorithm::SelectionSort;
+    }
+    return SortAlgorithm::MergeSort;
+}
+
+// 整数上观察不到稳定性：对带原始下标的记录排序，检查相等键是否保持原有顺序
+static bool measureStability(SortingAlgorithm algorithm) {
+    using Record = SortRecord<16>;
+    return probeStability<Record>(2048, [algorithm](std::span<Record> records) {
+        SortingEngine<Record, std::less<Record>, NoInstrumentation>().sort(toEngineAlgorithm(algorithm), records);
+    });
+}
+
 #define WM_APP_UPDATE_STATUS (WM_APP + 1)
 #define WM_APP_SET_PAUSE_TEXT (WM_APP + 2)
 
@@ -57,13 +83,15 @@ WinGUIVisualizer::WinGUIVisualizer()
       // ps left default-initialized
       ps(),
       rect(),
+      barRenderer(swapRedBlue(BarChartStyle())), // DIB 按 B, G, R 排列
+      dataGeneration(0),
+      dataSeed(0),
       isSorting(false),
       isPaused(false),
       currentAlgorithm(SortingAlgorithm::BubbleSort),
-      animationDelay(50),
+      replaySpeed(1.0),
       highlightIndex1(-1),
       highlightIndex2(-1),
-      barWidth(1),
       maxDataValue(0),
       comparisonCount(0),
       swapCount(0),
@@ -338,7 +366,8 @@ LRESULT CALLBACK WinGUIVisualizer::WindowProc(HWND hwnd, UINT uMsg, WPARAM wPara
                             if (size <= 0) size = 30;
                             if (size > 200) size = 200; // 限制最大数量以保证可视化效果
                             visualizer->generateData(size, DataPattern::Random);
-                            visualizer->updateStatus(L"已生成随机数据");
+                            visualizer->updateStatus(L"已生成随机数据（种子 " +
+                                                     std::to_wstring(visualizer->dataSeed) + L"）");
                         }
                         break;
                     case 2:
@@ -371,7 +400,8 @@ LRESULT CALLBACK WinGUIVisualizer::WindowProc(HWND hwnd, UINT uMsg, WPARAM wPara
                             if (size <= 0) size = 30;
                             if (size > 200) size = 200;
                             visualizer->generateData(size, DataPattern::PartiallySorted);
-                            visualizer->updateStatus(L"已生成部分有序数据");
+                            visualizer->updateStatus(L"已生成部分有序数据（种子 " +
+                                                     std::to_wstring(visualizer->dataSeed) + L"）");
                         }
                         break;
                         
@@ -536,10 +566,13 @@ void WinGUIVisualizer::refreshAll() {
                  RDW_INVALIDATE | RDW_ERASE | RDW_ALLCHILDREN | RDW_UPDATENOW);
 }
 
-void WinGUIVisualizer::generateData(size_t size, DataPattern pattern) {
+void WinGUIVisualizer::generateData(size_t size, DataPattern pattern, uint64_t seed) {
     std::lock_guard<std::mutex> lg(dataMutex);
-    data = generateTestData(size, pattern);
+    data = generateTestData(size, pattern, seed);
     originalData = data;
+    dataSeed = seed;
+    dataGeneration++;
+    clearHighlights();
     
     // 计算最大值用于缩放
     if (!data.empty()) {
@@ -547,17 +580,7 @@ void WinGUIVisualizer::generateData(size_t size, DataPattern pattern) {
     } else {
         maxDataValue = 1;
     }
-    
-    // 计算柱形宽度 使用客户区宽度以支持缩放
-    RECT clientRect;
-    GetClientRect(hwndCanvas ? hwndCanvas : hwnd, &clientRect);
-    int clientWidth = clientRect.right - clientRect.left;
-    if (size > 0) {
-        barWidth = std::max(1, (clientWidth - 40) / static_cast<int>(size));
-    } else {
-        barWidth = 1;
-    }
-    if (barWidth > 40) barWidth = 40; // 限制最大宽度
+    barRenderer.invalidate();
 
     // 重绘窗口（优先只重绘 canvas，避免重绘所有控件导致闪烁）
     if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
@@ -565,46 +588,17 @@ void WinGUIVisualizer::generateData(size_t size, DataPattern pattern) {
     // 不再调用 refreshAll
 }
 
-std::vector<int> WinGUIVisualizer::generateTestData(size_t size, DataPattern pattern) {
-    std::vector<int> testData(size);
-    
-    // 初始化顺序数据
-    for (size_t i = 0; i < size; i++) {
-        testData[i] = static_cast<int>(i + 1);
-    }
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    
-    switch (pattern) {
-        case DataPattern::Random:
-            std::shuffle(testData.begin(), testData.end(), gen);
-            break;
-            
-        case DataPattern::Descending:
-            std::reverse(testData.begin(), testData.end());
-            break;
-            
-        case DataPattern::PartiallySorted:
-            // 将大约70%的数据保持有序，其余打乱
-            if (size > 10) {
-                size_t unsortedSize = size * 0.3;
-                std::shuffle(testData.end() - unsortedSize, testData.end(), gen);
-            }
-            break;
-            
-        case DataPattern::Ascending:
-            // 默认就是升序，无需处理
-            break;
-    }
-    
-    return testData;
+// 与控制台版本共用 data_generator.h 的分布，取值为 1..size
+std::vector<int> WinGUIVisualizer::generateTestData(size_t size, DataPattern pattern, uint64_t seed) {
+    return generatePatternData<int>(size, pattern, PatternParams(), seed);
 }
 
 void WinGUIVisualizer::setData(const std::vector<int>& newData) {
     std::lock_guard<std::mutex> lg(dataMutex);
     data = newData;
     originalData = newData;
+    dataGeneration++;
+    clearHighlights();
     
     // 计算最大值用于缩放
     if (!data.empty()) {
@@ -612,18 +606,7 @@ void WinGUIVisualizer::setData(const std::vector<int>& newData) {
     } else {
         maxDataValue = 1;
     }
-    
-    // 计算柱形宽度
-    RECT clientRect;
-    GetClientRect(hwnd, &clientRect);
-    int clientWidth = clientRect.right - clientRect.left;
-    size_t size = data.size();
-    if (size > 0) {
-        barWidth = std::max(1, (clientWidth - 40) / static_cast<int>(size));
-    } else {
-        barWidth = 1;
-    }
-    if (barWidth > 40) barWidth = 40;
+    barRenderer.invalidate();
 
     // 重绘窗口
     if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
@@ -645,10 +628,13 @@ void WinGUIVisualizer::drawVisualization() {
                               DEFAULT_QUALITY, DEFAULT_PITCH | FF_SWISS, L"微软雅黑");
     HFONT oldFont = (HFONT)SelectObject(localHdc, hFont);
 
-    // 填充背景（黑色）
+    // 只填充柱状图以外的背景（黑色），柱状图区域由帧缓冲区整块覆盖
+    RECT area = barArea();
+    ExcludeClipRect(localHdc, area.left, area.top, area.right, area.bottom);
     HBRUSH backgroundBrush = CreateSolidBrush(RGB(0, 0, 0));
     FillRect(localHdc, &clientRect, backgroundBrush);
     DeleteObject(backgroundBrush);
+    SelectClipRgn(localHdc, nullptr);
 
     // 将当前绘制目标设置为窗口 HDC
     HDC prevHdc = hdc;
@@ -666,45 +652,52 @@ void WinGUIVisualizer::drawVisualization() {
     EndPaint(paintTarget, &localPs);
 }
 
-void WinGUIVisualizer::drawBars() {
-    std::lock_guard<std::mutex> lg(dataMutex);
-    if (data.empty()) return;
-    
-    // 获取客户区大小
+RECT WinGUIVisualizer::barArea() const {
     RECT clientRect;
-    HWND paintTarget = hwndCanvas ? hwndCanvas : hwnd;
-    GetClientRect(paintTarget, &clientRect);
+    GetClientRect(hwndCanvas ? hwndCanvas : hwnd, &clientRect);
     int clientHeight = clientRect.bottom - clientRect.top;
     int clientWidth = clientRect.right - clientRect.left;
 
     int baseY = clientHeight - 50; // 底部边距
     int maxHeight = std::max(10, clientHeight - 200); // 最大高度（为控件留出空间）
-    if (maxDataValue <= 0) maxDataValue = 1;
+    RECT area = {20, baseY - maxHeight, std::max(20, clientWidth - 20), baseY};
+    return area;
+}
 
-    // 如果 barWidth 太小或数据量变化，按客户区重新计算
-    if ((int)data.size() > 0) {
-        barWidth = std::max(1, (clientWidth - 40) / static_cast<int>(data.size()));
-    }
+// 只重画自上次绘制以来变化的列（尺寸或数据整体变化时整帧重画），再把帧缓冲区贴到窗口；
+// 窗口只在失效区域内实际写入像素
+void WinGUIVisualizer::drawBars() {
+    RECT area = barArea();
+    int width = area.right - area.left;
+    int height = area.bottom - area.top;
+    if (width <= 0 || height <= 0) return;
 
-    for (size_t i = 0; i < data.size(); i++) {
-        int barHeight = (static_cast<long long>(data[i]) * maxHeight) / maxDataValue;
-        int x = 20 + static_cast<int>(i) * barWidth;
-        int y = baseY - barHeight;
-        
-        RECT barRect = {x, y, x + barWidth - 1, baseY};
-        
-        // 根据状态设置颜色
-        HBRUSH brush;
-        int hi1 = highlightIndex1.load();
-        int hi2 = highlightIndex2.load();
-        if (static_cast<int>(i) == hi1 || static_cast<int>(i) == hi2) {
-            brush = CreateSolidBrush(RGB(255, 0, 0)); // 红色高亮
-        } else {
-            brush = CreateSolidBrush(RGB(0, 200, 255)); // 蓝色普通
-        }
-        
-        FillRect(hdc, &barRect, brush);
-        DeleteObject(brush);
+    std::lock_guard<std::mutex> lg(dataMutex);
+    if (canvasBuffer.width() != width || canvasBuffer.height() != height) canvasBuffer.resize(width, height);
+    BarValueRange range{0, std::max(1, maxDataValue)};
+    barRenderer.renderDirty(canvasBuffer, data, range, pendingDirty, highlightIndex1.load(), highlightIndex2.load());
+    pendingDirty.clear();
+
+    BITMAPINFO info = {};
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = width;
+    info.bmiHeader.biHeight = -height; // 自上而下
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+    SetDIBitsToDevice(hdc, area.left, area.top, width, height, 0, 0, 0, height, canvasBuffer.row(0), &info,
+                      DIB_RGB_COLORS);
+}
+
+void WinGUIVisualizer::invalidateIndices(const DirtyRanges& indices, size_t count) {
+    HWND target = hwndCanvas ? hwndCanvas : hwnd;
+    if (!target) return;
+    RECT area = barArea();
+    for (const DirtyRanges::Range& range : indices.ranges()) {
+        auto [first, last] = barColumnsOf(range.begin, range.end, count, area.right - area.left);
+        if (first >= last) continue;
+        RECT columns = {area.left + first, area.top, area.left + last, area.bottom};
+        InvalidateRect(target, &columns, FALSE);
     }
 }
 
@@ -718,42 +711,17 @@ void WinGUIVisualizer::drawUI() {
     TextOutW(hdc, 10, 5, infoText, (int)wcslen(infoText));
 }
 
-void WinGUIVisualizer::highlightBars(int index1, int index2) {
-     highlightIndex1.store(index1);
-     highlightIndex2.store(index2);
-     // 只使窗口无背景擦除刷新来减少闪烁
-    if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
-    else InvalidateRect(hwnd, nullptr, FALSE);
-     sleepAnimation();
- }
-
 void WinGUIVisualizer::clearHighlights() {
     highlightIndex1.store(-1);
     highlightIndex2.store(-1);
 }
 
-void WinGUIVisualizer::swap(int i, int j) {
-     if (i != j) {
-         {
-             std::lock_guard<std::mutex> lg(dataMutex);
-             std::swap(data[i], data[j]);
-             incrementSwaps();
-         }
-         // 请求重绘但保留背景（仅重绘 canvas）
-         if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
-         else InvalidateRect(hwnd, nullptr, FALSE);
-         sleepAnimation();
-     }
- }
-
-void WinGUIVisualizer::sleepAnimation() {
-    Sleep(animationDelay);
-}
-
 void WinGUIVisualizer::resetData() {
      std::lock_guard<std::mutex> lg(dataMutex);
      data = originalData;
+     dataGeneration++;
      clearHighlights();
+     barRenderer.invalidate();
     if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
     else InvalidateRect(hwnd, nullptr, FALSE);
  }
@@ -774,45 +742,41 @@ void WinGUIVisualizer::startSorting(SortingAlgorithm algorithm, bool skipSorting
         // Update pause button text on UI thread
         if (hwnd) PostMessageW(hwnd, WM_APP_SET_PAUSE_TEXT, 1, 0);
          resetCounters();
-         startTimer();
-
-         switch (algorithm) {
-             case SortingAlgorithm::BubbleSort:
-                updateStatus(L"正在执行冒泡排序...");
-                 bubbleSort();
-                 break;
-             case SortingAlgorithm::QuickSort:
-                updateStatus(L"正在执行快速排序...");
-                 quickSort();
-                 break;
-             case SortingAlgorithm::MergeSort:
-                updateStatus(L"正在执行归并排序...");
-                 mergeSort();
-                 break;
-             case SortingAlgorithm::HeapSort:
-                updateStatus(L"正在执行堆排序...");
-                 heapSort();
-                 break;
-             case SortingAlgorithm::InsertionSort:
-                updateStatus(L"正在执行插入排序...");
-                 insertionSort();
-                 break;
-             case SortingAlgorithm::SelectionSort:
-                updateStatus(L"正在执行选择排序...");
-                 selectionSort();
-                 break;
-         }
-
-         double timeElapsed = stopTimer();
-         isSorting = false;
-         clearHighlights();
-         if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
-         else InvalidateRect(hwnd, nullptr, FALSE);
-
-         // 显示排序完成信息
-         wchar_t msg[256];
-         swprintf_s(msg, L"排序完成，耗时: %.2f ms，比较: %zu 次，交换: %zu 次",
-                    timeElapsed, comparisonCount, swapCount);
+
+        std::vector<int> input;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lg(dataMutex);
+            input = data;
+            generation = ++dataGeneration; // 仍在回放的上一次排序就此停止
+        }
+        updateStatus(L"正在记录排序过程...");
+        SortTrace trace = recordSortTrace(toEngineAlgorithm(algorithm), input);
+        comparisonCount = trace.comparisons;
+        swapCount = trace.swaps;
+
+        updateStatus(L"正在回放排序过程...");
+        bool finished = replayTrace(trace, generation);
+
+        {
+            std::lock_guard<std::mutex> lg(dataMutex);
+            // 数据已被替换或已开始新的排序：界面状态交给新的一方，不再改动
+            if (generation != dataGeneration) return;
+            isSorting = false;
+            clearHighlights();
+            barRenderer.invalidate();
+        }
+        if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
+        else InvalidateRect(hwnd, nullptr, FALSE);
+        if (!finished) {
+            updateStatus(L"排序已停止");
+            return;
+        }
+
+        // 显示排序完成信息（耗时为引擎记录事件时的排序耗时，不含动画）
+        wchar_t msg[256];
+        swprintf_s(msg, L"排序完成，耗时: %.2f ms，比较: %zu 次，交换: %zu 次，事件: %zu 个",
+                   trace.recordMs, comparisonCount, swapCount, trace.events.size());
         updateStatus(msg);
 
          // 恢复暂停按钮文本
@@ -831,21 +795,24 @@ void WinGUIVisualizer::stopSorting() {
 }
 
 void WinGUIVisualizer::setAnimationSpeed(int speed) {
-    animationDelay = 101 - speed; // 反向映射，速度越高延迟越低
-    if (animationDelay < 1) animationDelay = 1;
-    if (animationDelay > 100) animationDelay = 100;
+    // 滑块 50 为每秒 1000 个事件，每 20 格变化 10 倍：1 约 3.5 个/秒，100 约 32 万个/秒
+    speed = std::clamp(speed, 1, 100);
+    replaySpeed = std::pow(10.0, (speed - 50) / 20.0);
 }
 
 void WinGUIVisualizer::updateStatus(const std::wstring& text) {
-    statusText = text;
-    if (!hwnd) return;
+    if (!hwnd) {
+        statusText = text;
+        return;
+    }
     // If caller is UI thread for this window, set directly, otherwise post to UI thread
+    // (statusText 只在界面线程中修改，工作线程的文本由 WM_APP_UPDATE_STATUS 写入)
     DWORD uiThreadId = GetWindowThreadProcessId(hwnd, nullptr);
     if (uiThreadId == GetCurrentThreadId()) {
+        statusText = text;
         if (hwndStaticStatus) SetWindowTextW(hwndStaticStatus, text.c_str());
     } else {
         // duplicate string and post to window to update on UI thread
-        size_t len = text.size() + 1;
         wchar_t* dup = (wchar_t*)_wcsdup(text.c_str());
         if (dup) {
             PostMessageW(hwnd, WM_APP_UPDATE_STATUS, 0, (LPARAM)dup);
@@ -868,337 +835,41 @@ double WinGUIVisualizer::stopTimer() {
     return duration.count() / 1000.0; // 转换为毫秒
 }
 
-void WinGUIVisualizer::incrementComparisons() {
-    comparisonCount++;
-}
-
-void WinGUIVisualizer::incrementSwaps() {
-    swapCount++;
-}
-
-// 排序算法实现
-void WinGUIVisualizer::bubbleSort() {
-    int n;
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        n = (int)data.size();
-    }
-
-    for (int i = 0; i < n - 1 && isSorting; i++) {
-        bool swapped = false;
-        for (int j = 0; j < n - i - 1 && isSorting; j++) {
-            while (isPaused) Sleep(100); // 暂停时等待
-            
-            incrementComparisons();
-            highlightBars(j, j + 1);
-            
-            int a, b;
-            {
-                std::lock_guard<std::mutex> lg(dataMutex);
-                a = data[j];
-                b = data[j+1];
-            }
-            if (a > b) {
-                swap(j, j + 1);
-                swapped = true;
-            }
-            
-            clearHighlights();
+// 按帧回放：每帧把到期的一批事件应用到回放器，只把脏区间拷回 data 并记入 pendingDirty，
+// 加锁一次，只使这些下标所在的列失效；高亮为本帧最后一个事件涉及的元素。
+// 停止或数据代号变化（重新生成、重置数据、开始新的排序）时丢弃剩余事件
+bool WinGUIVisualizer::replayTrace(const SortTrace& trace, uint64_t generation) {
+    constexpr double kReplayFramesPerSecond = 60.0;
+    TraceReplayer replayer(trace);
+    ReplayScheduler<> scheduler(kReplayFramesPerSecond, replaySpeed);
+    ReplayFrame frame;
+    while (!frame.finished && isSorting) {
+        if (isPaused) {
+            scheduler.pause();
+            Sleep(100);
+            continue;
         }
-        if (!swapped) break;
-    }
-}
+        scheduler.resume();
+        scheduler.setSpeed(replaySpeed);
 
-void WinGUIVisualizer::quickSort() {
-    int n;
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        n = (int)data.size();
-    }
-    if (n > 0) quickSortHelper(0, n - 1);
-}
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(scheduler.untilNextFrame());
+        if (wait.count() > 0) Sleep(static_cast<DWORD>(wait.count()));
+        if (!scheduler.nextFrame(replayer, frame)) continue;
 
-void WinGUIVisualizer::quickSortHelper(int low, int high) {
-    if (low < high && isSorting) {
-        while (isPaused) Sleep(100);
-        
-        int pi = partition(low, high);
-        quickSortHelper(low, pi - 1);
-        quickSortHelper(pi + 1, high);
-    }
-}
-
-int WinGUIVisualizer::partition(int low, int high) {
-    int pivot;
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        pivot = data[high];
-    }
-    int i = low - 1;
-    
-    for (int j = low; j <= high - 1 && isSorting; j++) {
-        while (isPaused) Sleep(100);
-        
-        incrementComparisons();
-        highlightBars(j, high);
-        
-        int valj;
+        std::span<const int> values = replayer.values();
         {
             std::lock_guard<std::mutex> lg(dataMutex);
-            valj = data[j];
-        }
-
-        if (valj < pivot) {
-            i++;
-            swap(i, j);
-        }
-        
-        clearHighlights();
-    }
-    swap(i + 1, high);
-    return i + 1;
-}
-
-void WinGUIVisualizer::mergeSort() {
-    int n;
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        n = (int)data.size();
-    }
-    if (n > 0) mergeSortHelper(0, n - 1);
-}
-
-void WinGUIVisualizer::mergeSortHelper(int left, int right) {
-    if (left < right && isSorting) {
-        while (isPaused) Sleep(100);
-        
-        int mid = left + (right - left) / 2;
-        mergeSortHelper(left, mid);
-        mergeSortHelper(mid + 1, right);
-        merge(left, mid, right);
-    }
-}
-
-void WinGUIVisualizer::merge(int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    
-    std::vector<int> leftArray(n1);
-    std::vector<int> rightArray(n2);
-    
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        for (int i = 0; i < n1; i++)
-            leftArray[i] = data[left + i];
-        for (int j = 0; j < n2; j++)
-            rightArray[j] = data[mid + 1 + j];
-    }
-
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2 && isSorting) {
-        while (isPaused) Sleep(100);
-        
-        incrementComparisons();
-        highlightBars(left + i, mid + 1 + j);
-        
-        int writeVal;
-        if (leftArray[i] <= rightArray[j]) {
-            writeVal = leftArray[i];
-            i++;
-        } else {
-            writeVal = rightArray[j];
-            j++;
-        }
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            data[k] = writeVal;
-        }
-        k++;
-        
-        if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE); // 不清除背景以减少闪烁
-        else InvalidateRect(hwnd, nullptr, FALSE);
-        sleepAnimation();
-        clearHighlights();
-    }
-    
-    while (i < n1 && isSorting) {
-        while (isPaused) Sleep(100);
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            data[k] = leftArray[i];
-        }
-        i++; k++;
-        if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
-        else InvalidateRect(hwnd, nullptr, FALSE);
-        sleepAnimation();
-    }
-    
-    while (j < n2 && isSorting) {
-        while (isPaused) Sleep(100);
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            data[k] = rightArray[j];
-        }
-        j++; k++;
-        if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
-        else InvalidateRect(hwnd, nullptr, FALSE);
-        sleepAnimation();
-    }
-}
-
-void WinGUIVisualizer::heapSort() {
-    int n;
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        n = (int)data.size();
-    }
-
-    for (int i = n / 2 - 1; i >= 0 && isSorting; i--) {
-        while (isPaused) Sleep(100);
-        heapify(n, i);
-    }
-    
-    for (int i = n - 1; i > 0 && isSorting; i--) {
-        while (isPaused) Sleep(100);
-        swap(0, i);
-        heapify(i, 0);
-    }
-}
-
-void WinGUIVisualizer::heapify(int n, int i) {
-    int largest = i;
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
-    
-    if (left < n && isSorting) {
-        while (isPaused) Sleep(100);
-        incrementComparisons();
-        int leftVal;
-        int largestVal;
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            leftVal = data[left];
-            largestVal = data[largest];
-        }
-        if (leftVal > largestVal) {
-            largest = left;
-        }
-    }
-    
-    if (right < n && isSorting) {
-        while (isPaused) Sleep(100);
-        incrementComparisons();
-        int rightVal;
-        int largestVal;
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            rightVal = data[right];
-            largestVal = data[largest];
-        }
-        if (rightVal > largestVal) {
-            largest = right;
-        }
-    }
-    
-    if (largest != i && isSorting) {
-        while (isPaused) Sleep(100);
-        swap(i, largest);
-        heapify(n, largest);
-    }
-}
-
-void WinGUIVisualizer::insertionSort() {
-    int n;
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        n = (int)data.size();
-    }
-
-    for (int i = 1; i < n && isSorting; i++) {
-        while (isPaused) Sleep(100);
-        
-        int key;
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            key = data[i];
-        }
-        int j = i - 1;
-        
-        highlightBars(i, -1); // 只高亮当前元素
-        
-        while (j >= 0 && isSorting) {
-            while (isPaused) Sleep(100);
-            int dj;
-            {
-                std::lock_guard<std::mutex> lg(dataMutex);
-                dj = data[j];
-            }
-            incrementComparisons();
-            if (dj > key) {
-                highlightBars(j, j + 1);
-                {
-                    std::lock_guard<std::mutex> lg(dataMutex);
-                    data[j + 1] = data[j];
-                }
-                j--;
-                if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
-                else InvalidateRect(hwnd, nullptr, FALSE);
-                sleepAnimation();
-                clearHighlights();
-            } else {
-                break;
+            if (generation != dataGeneration) return false;
+            for (const DirtyRanges::Range& range : frame.dirty.ranges()) {
+                std::copy(values.begin() + range.begin, values.begin() + range.end, data.begin() + range.begin);
+                pendingDirty.mark(range.begin, range.end);
             }
+            highlightIndex1.store(frame.highlight1);
+            highlightIndex2.store(frame.highlight2);
         }
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            data[j + 1] = key;
-        }
-        if (hwndCanvas) InvalidateRect(hwndCanvas, nullptr, FALSE);
-        else InvalidateRect(hwnd, nullptr, FALSE);
-        sleepAnimation();
-    }
-}
-
-void WinGUIVisualizer::selectionSort() {
-    int n;
-    {
-        std::lock_guard<std::mutex> lg(dataMutex);
-        n = (int)data.size();
-    }
-
-    for (int i = 0; i < n - 1 && isSorting; i++) {
-        while (isPaused) Sleep(100);
-        
-        int minIndex = i;
-        highlightBars(i, -1); // 高亮当前位置
-        
-        for (int j = i + 1; j < n && isSorting; j++) {
-            while (isPaused) Sleep(100);
-            
-            incrementComparisons();
-            highlightBars(minIndex, j);
-            
-            int valj, valmin;
-            {
-                std::lock_guard<std::mutex> lg(dataMutex);
-                valj = data[j];
-                valmin = data[minIndex];
-            }
-
-            if (valj < valmin) {
-                clearHighlights();
-                minIndex = j;
-                highlightBars(minIndex, -1);
-            }
-            
-            sleepAnimation();
-            clearHighlights();
-        }
-        
-        if (minIndex != i) {
-            swap(i, minIndex);
-        }
+        invalidateIndices(frame.dirty, values.size());
     }
+    return frame.finished;
 }
 
 void WinGUIVisualizer::runPerformanceComparison() {
@@ -1208,11 +879,11 @@ void WinGUIVisualizer::runPerformanceComparison() {
         
         performanceResults.clear();
         
-        // 保存当前数据
-        std::vector<int> savedData;
+        // 只在锁内复制一份原始数据，之后不再碰 data：回放线程可能正在写它
+        std::vector<int> input;
         {
             std::lock_guard<std::mutex> lg(dataMutex);
-            savedData = data;
+            input = originalData;
         }
 
         // 测试各种排序算法
@@ -1226,58 +897,28 @@ void WinGUIVisualizer::runPerformanceComparison() {
         };
         
         for (const auto& alg : algorithms) {
-            // 恢复原始数据
-            {
-                std::lock_guard<std::mutex> lg(dataMutex);
-                data = originalData;
-            }
-
             // 创建性能结果对象
             PerformanceResult result;
             result.algorithm = alg.first;
             result.name = alg.second;
             
-            // 执行排序并测量性能
-            resetCounters();
+            // 在数据副本上用不插桩的排序引擎计时，不带动画；比较/交换次数取自另一次计数运行
+            std::vector<int> work = input;
+            SortingEngine<int, std::less<int>, NoInstrumentation> timedEngine;
             startTimer();
-            
-            switch (alg.first) {
-                case SortingAlgorithm::BubbleSort:
-                    bubbleSort();
-                    break;
-                case SortingAlgorithm::QuickSort:
-                    quickSort();
-                    break;
-                case SortingAlgorithm::MergeSort:
-                    mergeSort();
-                    break;
-                case SortingAlgorithm::HeapSort:
-                    heapSort();
-                    break;
-                case SortingAlgorithm::InsertionSort:
-                    insertionSort();
-                    break;
-                case SortingAlgorithm::SelectionSort:
-                    selectionSort();
-                    break;
-            }
-            
+            timedEngine.sort(toEngineAlgorithm(alg.first), work);
             result.timeMs = stopTimer();
-            result.comparisons = comparisonCount;
-            result.swaps = swapCount;
-            result.isStable = (alg.first == SortingAlgorithm::BubbleSort || 
-                              alg.first == SortingAlgorithm::MergeSort || 
-                              alg.first == SortingAlgorithm::InsertionSort);
+
+            work = input;
+            SortingEngine<int> countingEngine;
+            countingEngine.sort(toEngineAlgorithm(alg.first), work);
+            result.comparisons = countingEngine.getComparisons();
+            result.swaps = countingEngine.getSwaps();
+            result.isStable = measureStability(alg.first);
             
             performanceResults.push_back(result);
         }
         
-        // 恢复数据
-        {
-            std::lock_guard<std::mutex> lg(dataMutex);
-            data = savedData;
-        }
-
         // 显示结果在新的窗口中
         std::wstring resultText = L"性能比较结果:\n\n";
         resultText += L"算法名称\t\t耗时(ms)\t比较次数\t交换次数\t稳定性\n";
@@ -10,18 +10,11 @@
 #include <tchar.h>
 #include <vector>
 #include <algorithm>
-#include <random>
 #include <chrono>
 #include <mutex>
 #include <atomic>
-
-// 数据生成类型枚举
-enum class DataPattern {
-    Random,
-    Ascending,
-    Descending,
-    PartiallySorted
-};
+#include "data_generator.h"
+#include "frame_renderer.h"
 
 // 排序算法枚举
 enum class SortingAlgorithm {
@@ -77,15 +70,23 @@ private:
     std::vector<int> data;
     std::vector<int> originalData;
     std::vector<PerformanceResult> performanceResults;
-    int barWidth;
     int maxDataValue;
     std::mutex dataMutex; // 保护 data / originalData / related members
 
+    // 柱状图先画进与平台无关的帧缓冲区（frame_renderer.h），再整块贴到窗口；
+    // 回放时只重画 pendingDirty 中的下标所在的列，尺寸或数据整体变化时整帧重画（均受 dataMutex 保护）
+    Framebuffer canvasBuffer;
+    BarChartRenderer barRenderer;
+    DirtyRanges pendingDirty;
+    // 数据被整体替换或开始新的排序时递增；回放线程发现代号变化即停止，不再写入已被替换的 data（受 dataMutex 保护）
+    uint64_t dataGeneration;
+    uint64_t dataSeed; // 最近一次生成数据使用的种子（显示在状态栏，便于复现）
+
     // 排序状态
-    bool isSorting;
-    bool isPaused;
+    std::atomic<bool> isSorting; // 界面线程与排序线程共享
+    std::atomic<bool> isPaused;
     SortingAlgorithm currentAlgorithm;
-    int animationDelay; // 毫秒
+    std::atomic<double> replaySpeed; // 回放速度倍数，见 replay_scheduler.h
     std::wstring statusText;
     
     // 当前高亮的元素 (使用原子以便在线程间读取)
@@ -111,31 +112,24 @@ public:
     void createControls();
     void layoutControls();
     
-    // 数据管理
-    void generateData(size_t size, DataPattern pattern);
+    // 数据管理：数据由 data_generator.h 按种子生成，同一种子总是得到相同的数据
+    void generateData(size_t size, DataPattern pattern, uint64_t seed = randomSeed());
     void resetData();
     void setData(const std::vector<int>& newData);
     
-    // 排序算法（带可视化）
-    void bubbleSort();
-    void quickSort();
-    void mergeSort();
-    void heapSort();
-    void insertionSort();
-    void selectionSort();
-    
-    // 排序辅助函数
-    void quickSortHelper(int low, int high);
-    int partition(int low, int high);
-    void merge(int left, int mid, int right);
-    void mergeSortHelper(int left, int right);
-    void heapify(int n, int i);
-    
+    // 动画回放：排序先在 SortingEngine 中全速运行并记录事件（sort_trace.h），
+    // 再由 ReplayScheduler 按固定帧率回放，每帧合并一批事件只重绘一次。
+    // generation 为开始回放时的数据代号；回放到最后时返回 true，被停止或数据被替换时返回 false
+    bool replayTrace(const SortTrace& trace, uint64_t generation);
+
     // 可视化相关
     void drawVisualization();
     void drawBars();
     void drawUI();
-    void highlightBars(int index1, int index2);
+    // 柱状图在绘图区中的矩形（两侧留 20 像素，下方留 50 像素，上方为控件留出空间）
+    RECT barArea() const;
+    // 只使下标区间对应的列失效，而不是整个绘图区
+    void invalidateIndices(const DirtyRanges& indices, size_t count);
     void clearHighlights();
     void updateStatus(const std::wstring& text);
     void refreshAll(); // 声明全局刷新方法，解决无法解析符号
@@ -144,20 +138,16 @@ public:
     void startSorting(SortingAlgorithm algorithm, bool skipSorting);
     void pauseResume();
     void stopSorting();
-    void setAnimationSpeed(int speed); // 1-100, 100最快
+    void setAnimationSpeed(int speed); // 1-100, 100最快（按指数映射为回放速度倍数）
     void runPerformanceComparison();
     
     // 工具函数
-    static std::vector<int> generateTestData(size_t size, DataPattern pattern);
+    static std::vector<int> generateTestData(size_t size, DataPattern pattern, uint64_t seed);
     
 private:
-    void swap(int i, int j);
-    void sleepAnimation();
     void resetCounters();
     void startTimer();
     double stopTimer();
-    void incrementComparisons();
-    void incrementSwaps();
 };
 
 #endif // _WIN32